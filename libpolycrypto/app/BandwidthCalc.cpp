@@ -2,6 +2,7 @@
 #include <string>
 
 #include <polycrypto/PolyCrypto.h>
+#include <polycrypto/PointCompression.h>
 
 #include <xutils/Utils.h>
 #include <xutils/Log.h>
@@ -12,6 +13,9 @@ using namespace boost::multiprecision;
 using namespace std;
 using namespace libpolycrypto;
 
+// Group elements are sent compressed (see PointCompression.h)
+const size_t G1Size = G1CompressedSize;
+
 /**
  * How do we reason about bandwidth in (t, n) DKG? (i.e., need t shares to reconstruct)
  *  - c   = the size of a poly commitment
@@ -64,7 +68,7 @@ T calcUpload(T n, T c, T s, T p, T f0c, T f0p) {
 template<class T>
 std::tuple<T,T> feldman(T n, T t) {
     const T polyDeg = (t - 1);
-    const T commSize = 32 * (polyDeg + 1); // need to send a group element for each coeff of the poly
+    const T commSize = G1Size * (polyDeg + 1); // need to send a group element for each coeff of the poly
     const T shareSize = 32;        // share is just a field element
     const T proofSize = 0;         // can verify share against commitment directly (not true for Pedersen though: needs 32-byte r(i))
     const T f0commSize = 0;        // g^f(0) is already part of the Feldman commitment to the first coeff c_0 = f(0)
@@ -77,14 +81,14 @@ std::tuple<T,T> feldman(T n, T t) {
 
 template<class T>
 std::tuple<T,T> kate(T n) {
-    const T commSize = 32;          // g^p(s) is one group element
+    const T commSize = G1Size;      // g^p(s) is one group element
     const T shareSize = 32;         // share is a field element
-    const T proofSize = 32;         // proof is g^{p(s) - p(i) / (x - i)}: one group element
-    const T f0commSize = 32;        // one group element
+    const T proofSize = G1Size;     // proof is g^{p(s) - p(i) / (x - i)}: one group element
+    const T f0commSize = G1Size;    // one group element
     // a Schnorr signature (e = H(g || g^k || g^x || proverID || bla), s = k + ex)
     // Reference: https://tools.ietf.org/html/rfc8235#page-8
     const T nizkPok = 64;           // basically a Schnorr signature
-    const T f0proofSize = 32 + nizkPok; // g^f(0) proof: normal Kate proof + a NIZKPoK of f(0) w.r.t. g
+    const T f0proofSize = G1Size + nizkPok; // g^f(0) proof: normal Kate proof + a NIZKPoK of f(0) w.r.t. g
 
     return std::make_tuple(
         calcDownload(n, commSize, shareSize, proofSize, f0commSize, f0proofSize),
@@ -98,14 +102,14 @@ template<class T>
 std::tuple<T,T> amt(T n, T t) {
     // a tree of n = 2^i nodes has i + 1 nodes along any path and that's how many quotient commitments will be in our proof
     // when n is not a power of two, we round up using log2ceil
-    const T commSize = 32;
+    const T commSize = G1Size;
     const T shareSize = 32;
     // we are only evaluating at n points this time, and proving g^f(0) using a normal Kate proof
     //const T numLevels = Utils::log2ceil(n) + 1;
-    const T proofSize = (Utils::log2floor(t-1) + 1) * 32;
-    const T f0commSize = 32;
+    const T proofSize = (Utils::log2floor(t-1) + 1) * G1Size;
+    const T f0commSize = G1Size;
     const T nizkPok = 64;           // see kate() description
-    const T f0proofSize = 32 + nizkPok;    // proof for g^f(0) is now a normal constant-sized Kate proof (+ NIZKPoK)
+    const T f0proofSize = G1Size + nizkPok;    // proof for g^f(0) is now a normal constant-sized Kate proof (+ NIZKPoK)
 
     //loginfo << " * numLevels = " << numLevels << " (for n = " << n << ")" << endl;
 
@@ -0,0 +1,42 @@
+#include <iostream>
+
+#include <polycrypto/PolyCrypto.h>
+
+#include <polycrypto/KatePublicParameters.h>
+
+using namespace std;
+using namespace libpolycrypto;
+
+int main(int argc, char *argv[])
+{
+    libpolycrypto::initialize(nullptr, 0);
+
+    if(argc < 3) {
+        cout << "Usage: " << argv[0] << " <trapdoor-in-file> <binary-out-file> [<max-q> [<compress>]]" << endl;
+        cout << endl;
+        cout << "Reads the text parameters from <trapdoor-in-file>-<i> for i = 0, 1, ... and writes them to <binary-out-file>" << endl;
+        cout << "in the binary format read by KatePublicParameters::fromBinary(). If <max-q> is given and not 0, only g^{s^i} for i \\in [0, <max-q>] are written." << endl;
+        cout << "If <compress> is 1, points are written compressed (smaller, but slower to read back)." << endl;
+        return 1;
+    }
+
+    string inFile(argv[1]);
+    string outFile(argv[2]);
+    size_t maxQ = argc < 4 ? 0 : static_cast<size_t>(std::stoi(argv[3]));
+    bool compressed = argc < 5 ? false : std::stoi(argv[4]) != 0;
+
+    Dkg::KatePublicParameters pp(inFile, maxQ, true, false);
+
+    loginfo << "Writing " << pp.q + 1 << (compressed ? " compressed" : "") << " binary parameters to '" << outFile << "' ..." << endl;
+    pp.writeBinary(outFile, compressed);
+
+    // read them back, to make sure the file is good
+    Dkg::KatePublicParameters bpp = Dkg::KatePublicParameters::fromBinary(outFile, inFile);
+    if(bpp.g1si != pp.g1si || bpp.g2si != pp.g2si) {
+        throw std::runtime_error("Binary parameters read back do not match the text ones");
+    }
+
+    loginfo << "All done!" << endl;
+
+    return 0;
+}
@@ -10,29 +10,38 @@ int main(int argc, char *argv[])
 {
     libpolycrypto::initialize(nullptr, 0);
 
-    if(argc < 5) {
-        cout << "Usage: " << argv[0] << " <trapdoor-file> <out-file> <start-incl> <end-excl>" << endl;
+    if(argc < 2 || (argc > 3 && argc < 5)) {
+        cout << "Usage: " << argv[0] << " <trapdoor-file> [<binary-out-file>]" << endl;
+        cout << "   or: " << argv[0] << " <trapdoor-file> <out-file> <start-incl> <end-excl>" << endl;
         cout << endl;
-        cout << "Reads 's' from <trapdoor-file> and outputs q-SDH parameters (g_1^{s_i}) for i \\in [<start-incl>, <end-excl>) to <out-file>." << endl;
+        cout << "Reads 's' and 'q' from <trapdoor-file> and outputs all q-SDH parameters (g_1^{s_i}) for i \\in [0, q], using all cores." << endl;
+        cout << "If <binary-out-file> is given, writes them there in the binary format. Otherwise, writes them to <trapdoor-file>-<i>, one chunk per core." << endl;
+        cout << endl;
+        cout << "In the second form, only outputs the parameters for i \\in [<start-incl>, <end-excl>) to <out-file>." << endl;
         return 1;
     }
 
     string inFile(argv[1]);
-    string outFile(argv[2]);
-    size_t start = static_cast<size_t>(std::stoi(argv[3])),
-        end = static_cast<size_t>(std::stoi(argv[4]));
-
-    ifstream fin(inFile);
-
-    if(fin.fail()) {
-        throw std::runtime_error("Could not read trapdoors input file");
-    }
 
     Fr s;
-    fin >> s;
-
-    Dkg::KatePublicParameters::generate(start, end, s, outFile, true);
-
+    size_t q;
+    Dkg::KatePublicParameters::readTrapdoor(inFile, s, q);
+
+    if(argc >= 5) {
+        string outFile(argv[2]);
+        size_t start = static_cast<size_t>(std::stoi(argv[3])),
+            end = static_cast<size_t>(std::stoi(argv[4]));
+
+        Dkg::KatePublicParameters::generate(start, end, s, outFile, true);
+    } else if(argc == 3) {
+        string outFile(argv[2]);
+
+        Dkg::KatePublicParameters pp = Dkg::KatePublicParameters::fromTrapdoor(s, q);
+        loginfo << "Writing binary parameters to '" << outFile << "' ..." << endl;
+        pp.writeBinary(outFile);
+    } else {
+        Dkg::KatePublicParameters::generateChunks(s, q, inFile, getNumCores(), true);
+    }
 
     loginfo << "All done!" << endl;
 
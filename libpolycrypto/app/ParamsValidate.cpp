@@ -12,15 +12,24 @@ int main(int argc, char *argv[])
     libpolycrypto::initialize(nullptr, 0);
     
     if(argc < 2) {
-        cout << "Usage: " << argv[0] << " <trapdoor-in-file>" << endl;
+        cout << "Usage: " << argv[0] << " <trapdoor-in-file> [<use-trapdoor>]" << endl;
         cout << endl;
         cout << "Reads 's', 'q' from <trapdoor-in-file> and then reads the parameters from <trapdoor-in-file>-<i> for i = 0, 1, ..." << endl;
+        cout << "The parameters are checked with a few multiexps and pairings, without the trapdoor." << endl;
+        cout << "If <use-trapdoor> is 1, every parameter is also recomputed from 's' and compared (slow)." << endl;
         return 1;
     }
 
     string inFile(argv[1]);
+    bool useTrapdoor = argc < 3 ? false : std::stoi(argv[2]) != 0;
 
-    Dkg::KatePublicParameters pp(inFile, 0, true, true);
+    Dkg::KatePublicParameters pp(inFile, 0, true, useTrapdoor);
+
+    loginfo << "Validating " << pp.q + 1 << " parameters without the trapdoor..." << endl;
+    if(!pp.validatePowers()) {
+        logerror << "The parameters in '" << inFile << "-*' are NOT valid" << endl;
+        return 1;
+    }
 
     loginfo << "All done!" << endl;
 
@@ -29,13 +29,14 @@ int main(int argc, char *argv[]) {
     libpolycrypto::initialize(nullptr, 0);
 
     if(argc < 5) {
-        cout << "Usage: " << argv[0] << "<t> <n> <r>" << endl;
+        cout << "Usage: " << argv[0] << "<t> <n> <r> [<arity>]" << endl;
         cout << endl;
         cout << "OPTIONS: " << endl;
         cout << "   <pp-file>   the Kate public parameters file" << endl;
         cout << "   <t>    the degree of the evaluated polynomial + 1" << endl;
         cout << "   <n>    the # of points to evaluate at (i.e., # of AMT leaves)" << endl;  
         cout << "   <r>    the # of times to repeat the AMT auth + verif" << endl;
+        cout << "   <arity>    the # of children of every AMT node, a power of two (default: 2)" << endl;
         cout << endl;
 
         return 1;
@@ -45,10 +46,11 @@ int main(int argc, char *argv[]) {
     size_t t = static_cast<size_t>(std::stoi(argv[2]));
     size_t n = static_cast<size_t>(std::stoi(argv[3]));
     size_t r = static_cast<size_t>(std::stoi(argv[4]));
+    size_t arity = argc > 5 ? static_cast<size_t>(std::stoi(argv[5])) : 2;
 
     std::unique_ptr<Dkg::KatePublicParameters> kpp(
         new Dkg::KatePublicParameters(ppFile, t-1));
-    loginfo << "Degree t = " << t - 1 << " poly, evaluated at n = " << n << " points, iters = " << r << endl;
+    loginfo << "Degree t = " << t - 1 << " poly, evaluated at n = " << n << " points, iters = " << r << ", arity = " << arity << endl;
 
     AveragingTimer at("Accum tree");
     at.startLap();
@@ -66,7 +68,7 @@ int main(int argc, char *argv[]) {
     // Step 1: Fast multipoint eval
     AveragingTimer c1("Roots-of-unity eval ");
     c1.startLap();
-    RootsOfUnityEvaluation eval(f, accs);
+    RootsOfUnityEvaluation eval(f, accs, arity);
     std::vector<Fr> evals = eval.getEvaluations();
     mus = c1.endLap();
 
@@ -99,12 +101,27 @@ int main(int argc, char *argv[]) {
         logperf << " - AuthRootsOfUnityEval (iter " << i << "): " << Utils::humanizeMicroseconds(mus, 2) << endl;
     }
 
+    // Step 3': Evaluate and authenticate in one pass, without storing the multipoint eval tree
+    AveragingTimer as("Streaming roots-of-unity eval + auth");
+    for(size_t i = 0; i < r; i++) {
+        std::vector<Fr> sevals;
+        as.startLap();
+        AuthRootsOfUnityEvaluation authEval(f, accs, *kpp, false, sevals, arity);
+        mus = as.endLap();
+
+        if(sevals != evals)
+            throw std::runtime_error("Streaming AMT evaluations disagree with the multipoint eval");
+
+        logperf << " - Streaming AuthRootsOfUnityEval (iter " << i << "): " << Utils::humanizeMicroseconds(mus, 2) << endl;
+    }
+
     logperf << endl;
     logperf << at << endl;
     logperf << c1 << endl;
     logperf << aat << endl;
     logperf << ar << endl;
     logperf << ars << endl;
+    logperf << as << endl;
     logperf << endl;
      
     // Step 4: Verify AMT proofs (TODO: implement)
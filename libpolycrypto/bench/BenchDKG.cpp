@@ -89,6 +89,14 @@ void benchmarkDkg(
         loginfo << " - " << p->id << ": " << Utils::humanizeMicroseconds(mus, 2) << endl;
     }
 
+    // players that evaluate with FFTs (i.e., Feldman) can also deal together, with one batched FFT
+    if(realPlayers.size() > 1 && realPlayers[0]->evaluatesWithFFT()) {
+        ManualTimer t;
+        AbstractPlayer::dealAll(realPlayers);
+        auto mus = t.stop().count() / static_cast<long>(realPlayers.size());
+        logperf << "Batched deal of " << realPlayers.size() << " players: " << Utils::humanizeMicroseconds(mus, 2) << " per player" << endl;
+    }
+
     // We need to create an array of all players for estimating the verification time.
     // We do this by repeatedly including players from realPlayers, but we cannot repeatedly include
     // the verifying player itself more than once, because that would bring the verification
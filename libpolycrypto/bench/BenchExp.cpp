@@ -1,4 +1,5 @@
 #include <polycrypto/PolyCrypto.h>
+#include <polycrypto/ScalarMult.h>
 
 #include <vector>
 #include <cmath>
@@ -15,6 +16,80 @@ using namespace std;
 
 using namespace libpolycrypto;
 
+template<class Group>
+void benchExp(size_t n, const char * groupName) {
+    loginfo << "Picking " << n << " random " << groupName << " elements..." << endl;
+    auto a = random_group_elems<Group>(n);
+    loginfo << "Picking " << n << " random field elements..." << endl;
+    auto e = random_field_elems(n);
+
+    loginfo << "Doing " << n << " " << groupName << " exponentiations..." << endl;
+    AveragingTimer tn(std::string(groupName) + " exp (libff)");
+    std::vector<Group> r1(n), r2(n);
+    for(size_t i = 0; i < n; i++) {
+        tn.startLap();
+        r1[i] = e[i]*a[i];
+        tn.endLap();
+    }
+
+    logperf << tn << endl;
+    logperf << "Total time: " << Utils::humanizeMicroseconds(tn.totalLapTime()) << endl;
+
+    AveragingTimer tg(std::string(groupName) + (Endomorphism<Group>::Enabled ? " exp (GLV)" : " exp (wNAF)"));
+    for(size_t i = 0; i < n; i++) {
+        tg.startLap();
+        r2[i] = scalarMul(e[i], a[i]);
+        tg.endLap();
+    }
+
+    logperf << tg << endl;
+    logperf << "Total time: " << Utils::humanizeMicroseconds(tg.totalLapTime()) << endl;
+
+    if(r1 != r2) {
+        throw std::runtime_error("scalarMul() disagrees with libff");
+    }
+}
+
+template<class Group>
+Group generatorExp(const Fr& k);
+
+template<>
+G1 generatorExp<G1>(const Fr& k) { return g1Exp(k); }
+
+template<>
+G2 generatorExp<G2>(const Fr& k) { return g2Exp(k); }
+
+template<class Group>
+void benchGeneratorExp(size_t n, const char * groupName) {
+    auto e = random_field_elems(n);
+
+    // the first call builds the table
+    ManualTimer tt;
+    generatorExp<Group>(Fr::one());
+    logperf << groupName << " generator table: " << Utils::humanizeMicroseconds(tt.stop().count()) << endl;
+
+    AveragingTimer tn(std::string(groupName) + " generator exp (libff)");
+    std::vector<Group> r1(n), r2(n);
+    for(size_t i = 0; i < n; i++) {
+        tn.startLap();
+        r1[i] = e[i] * Group::one();
+        tn.endLap();
+    }
+    logperf << tn << endl;
+
+    AveragingTimer tg(std::string(groupName) + " generator exp (table)");
+    for(size_t i = 0; i < n; i++) {
+        tg.startLap();
+        r2[i] = generatorExp<Group>(e[i]);
+        tg.endLap();
+    }
+    logperf << tg << endl;
+
+    if(r1 != r2) {
+        throw std::runtime_error("Generator table disagrees with libff");
+    }
+}
+
 int main(int argc, char *argv[]) {
     libpolycrypto::initialize(nullptr, 0);
 
@@ -30,23 +105,11 @@ int main(int argc, char *argv[]) {
 
     size_t n = static_cast<size_t>(std::stoi(argv[1]));
 
-    loginfo << "Picking " << n << " random group elements..." << endl;
-    auto a = random_group_elems<G1>(n);
-    loginfo << "Picking " << n << " random field elements..." << endl;
-    auto e = random_field_elems(n);
+    benchExp<G1>(n, "G1");
+    benchExp<G2>(n, "G2");
 
-    loginfo << "Doing " << n << " exponentiations..." << endl;
-    AveragingTimer tn("Exp");
-    G1 r;
-    for(size_t i = 0; i < n; i++) {
-        tn.startLap();
-        r = e[i]*a[i];
-        tn.endLap();
-    }
-
-    logperf << tn << endl;
-    
-    logperf << "Total time: " << Utils::humanizeMicroseconds(tn.totalLapTime()) << endl;
+    benchGeneratorExp<G1>(n, "G1");
+    benchGeneratorExp<G2>(n, "G2");
 
     return 0;
 }
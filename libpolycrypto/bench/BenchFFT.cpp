@@ -30,7 +30,11 @@ int main(int argc, char *argv[])
         count = static_cast<size_t>(std::stoi(argv[3]));
 
     AveragingTimer 
-        df("FFT");
+        df("FFT"),
+        dl("libfqfft FFT"),
+        dt("Truncated FFT (first n/2 + 1 outputs)"),
+        di("Inverse FFT"),
+        db("Batched FFT of 16 polynomials");
 
     // Step 0: Pick random polynomial
     vector<Fr> p = random_field_elems(d+1), vals;
@@ -43,9 +47,48 @@ int main(int argc, char *argv[])
         df.startLap();
         poly_fft(p, n, vals);
         df.endLap();
+
+        // Step 2: Compare with libfqfft's radix-2 FFT
+        vector<Fr> lvals = p;
+        lvals.resize(n, Fr::zero());
+        dl.startLap();
+        libfqfft::_basic_serial_radix2_FFT(lvals, libff::get_root_of_unity<Fr>(n));
+        dl.endLap();
+
+        if(lvals != vals)
+            throw std::runtime_error("FFT disagrees with libfqfft");
+
+        // Step 3: Only compute the first n/2 + 1 evaluations, like for n = 2f + 1 players
+        vector<Fr> tvals;
+        dt.startLap();
+        fft_truncated(p, n, std::min(n, n/2 + 1), tvals);
+        dt.endLap();
+
+        // Step 4: Go back to the coefficients
+        vector<Fr> coeffs;
+        di.startLap();
+        ifft(vals, coeffs);
+        di.endLap();
+
+        coeffs.resize(p.size());
+        if(coeffs != p)
+            throw std::runtime_error("Inverse FFT did not give back the polynomial");
+
+        // Step 5: Do 16 FFTs at once, like for 16 dealers
+        vector<vector<Fr>> polys(16, p), bvals;
+        db.startLap();
+        fft_batch(polys, n, bvals);
+        db.endLap();
+
+        if(bvals[15] != vals)
+            throw std::runtime_error("Batched FFT disagrees with FFT");
     }
 
     logperf << df << endl;
+    logperf << dl << endl;
+    logperf << dt << endl;
+    logperf << di << endl;
+    logperf << db << endl;
 
     return 0;
 }
@@ -1,5 +1,8 @@
 #include <polycrypto/PolyOps.h>
 #include <polycrypto/PolyCrypto.h>
+#include <polycrypto/Pippenger.h>
+#include <polycrypto/FixedBaseMultiExp.h>
+#include <polycrypto/MultiExpProfile.h>
 #include <polycrypto/RootsOfUnityEval.h>
 
 #include <vector>
@@ -7,9 +10,15 @@
 #include <iostream>
 #include <ctime>
 #include <fstream>
+#include <limits>
+
+#ifdef USE_MULTITHREADING
+# include <omp.h>
+#endif
 
 #include <xutils/Log.h>
 #include <xutils/Timer.h>
+#include <xutils/Utils.h>
 #include <xassert/XAssert.h>
 
 using namespace std;
@@ -54,16 +63,138 @@ void benchAllRootsOfUnity(size_t n, size_t r) {
     }
 }
 
+/**
+ * Times Pippenger on 1, 2, 4, ... cores, up to all of them, against libff's sequential multiexp.
+ */
+void benchScaling(const std::vector<G1>& bases, const std::vector<Fr>& exp, size_t r) {
+    size_t n = bases.size();
+
+    AveragingTimer tl("libff multiexp (1 core)");
+    for(size_t i = 0; i < r; i++) {
+        tl.startLap();
+        libff::multi_exp<G1, Fr, libff::multi_exp_method_BDLO12>(bases.cbegin(), bases.cend(), exp.cbegin(), exp.cend(), 1);
+        tl.endLap();
+    }
+    logperf << tl << endl;
+
+    size_t maxCores = libpolycrypto::getNumCores();
+    for(size_t cores = 1; cores <= maxCores; cores = cores < maxCores && cores * 2 > maxCores ? maxCores : cores * 2) {
+#ifdef USE_MULTITHREADING
+        omp_set_num_threads(static_cast<int>(cores));
+#endif
+        std::string name = "Pippenger multiexp (" + std::to_string(cores) + " cores)";
+        AveragingTimer tp(name.c_str());
+        for(size_t i = 0; i < r; i++) {
+            tp.startLap();
+            libpolycrypto::pippengerMultiExp<G1, Fr>(bases.cbegin(), bases.cend(), exp.cbegin(), exp.cend(), cores);
+            tp.endLap();
+        }
+
+        logperf << tp << endl;
+        logperf << "Speedup over libff: " << static_cast<double>(tl.averageLapTime()) / static_cast<double>(tp.averageLapTime())
+                << "x (" << static_cast<double>(tp.averageLapTime()) / static_cast<double>(n) << " microseconds per exp)" << endl;
+
+        if(cores == maxCores)
+            break;
+    }
+
+#ifdef USE_MULTITHREADING
+    omp_set_num_threads(static_cast<int>(maxCores));
+#endif
+}
+
+/**
+ * Times building a fixed-base table and multiexps with it, against regular multiexps.
+ */
+void benchFixedBase(const std::vector<G1>& bases, const std::vector<Fr>& exp, size_t r) {
+    AveragingTimer tb("Fixed-base table");
+    tb.startLap();
+    libpolycrypto::FixedBaseTable<G1> table(bases.cbegin(), bases.cend());
+    tb.endLap();
+    logperf << tb << " (window = " << table.getWindowSize() << ", " << Utils::humanizeBytes(table.getMemoryUsage()) << ")" << endl;
+
+    AveragingTimer tm("Multiexp");
+    AveragingTimer tf("Fixed-base multiexp");
+    for(size_t i = 0; i < r; i++) {
+        tm.startLap();
+        libpolycrypto::multiExp<G1>(bases, exp);
+        tm.endLap();
+
+        tf.startLap();
+        libpolycrypto::multiExp<G1>(table, exp);
+        tf.endLap();
+    }
+
+    logperf << tm << endl;
+    logperf << tf << endl;
+    logperf << "Speedup: " << static_cast<double>(tm.averageLapTime()) / static_cast<double>(tf.averageLapTime()) << "x" << endl;
+}
+
+/**
+ * Measures the multiexp thresholds for G1 and G2 with 1, 2, 4, ... threads, up to all cores,
+ * and writes them to a profile that initialize() loads (see MultiExpProfile.h).
+ */
+void calibrate(const std::string& profileFile, size_t maxSize) {
+    using libpolycrypto::MultiExpProfileEntry;
+    using libpolycrypto::calibrateMultiExp;
+
+    std::vector<MultiExpProfileEntry> entries;
+    size_t maxCores = libpolycrypto::getNumCores();
+#ifdef USE_MULTITHREADING
+    for(size_t cores = 1; cores <= maxCores; cores = cores < maxCores && cores * 2 > maxCores ? maxCores : cores * 2) {
+#else
+    for(size_t cores = maxCores; cores <= maxCores; cores++) {
+#endif
+        MultiExpProfileEntry g1, g2;
+        g1.group = "G1";
+        g1.numThreads = cores;
+        g1.thresholds = calibrateMultiExp<G1>(cores, maxSize);
+        g2.group = "G2";
+        g2.numThreads = cores;
+        g2.thresholds = calibrateMultiExp<libpolycrypto::G2>(cores, maxSize);
+
+        auto from = [](size_t th) {
+            return th == std::numeric_limits<size_t>::max() ? std::string("never") : "from " + std::to_string(th);
+        };
+
+        for(auto& e : { g1, g2 }) {
+            logperf << e.group << " with " << cores << " threads: Bos-Coster " << from(e.thresholds.bosCoster)
+                    << ", BDLO12 " << from(e.thresholds.bdlo12) << ", Pippenger " << from(e.thresholds.pippenger) << endl;
+            entries.push_back(e);
+        }
+
+        if(cores == maxCores)
+            break;
+    }
+
+    libpolycrypto::writeMultiExpProfile(profileFile, entries);
+    loginfo << "Wrote multiexp profile to '" << profileFile << "'. Set "
+            << libpolycrypto::MultiExpProfileEnvVar << "=" << profileFile << " to use it." << endl;
+}
+
 int main(int argc, char *argv[]) {
     libpolycrypto::initialize(nullptr, 0);
     srand(static_cast<unsigned int>(time(nullptr)));
 
+    if(argc >= 3 && std::string(argv[1]) == "calibrate") {
+        size_t maxSize = argc > 3 ? static_cast<size_t>(std::stoi(argv[3])) : 1u << 16;
+        calibrate(argv[2], maxSize);
+        return 0;
+    }
+
     if(argc < 3) {
-        cout << "Usage: " << argv[0] << " <n> <r>" << endl;
+        cout << "Usage: " << argv[0] << " <n> <r> [scaling|fixed]" << endl;
+        cout << "   or: " << argv[0] << " calibrate <profile-out-file> [<max-n>]" << endl;
         cout << endl;
         cout << "OPTIONS: " << endl;
         cout << "   <n>    the number of exponentiations to do in a single multiexp" << endl;  
         cout << "   <r>    the number of times to repeat the multiexps" << endl;  
+        cout << "   scaling    if given, shows how the multiexp scales with the number of cores" << endl;
+        cout << "   fixed      if given, compares multiexps with a precomputed fixed-base table to regular ones" << endl;
+        cout << endl;
+        cout << "   calibrate  measures which multiexp method is fastest at which size on this machine, for G1 and G2" << endl;
+        cout << "              and for every thread count, up to <max-n> (default: 2^16) exponentiations, and writes" << endl;
+        cout << "              the thresholds to <profile-out-file>, for initialize() to load" << endl;
         cout << endl;
 
         return 1;
@@ -86,6 +217,16 @@ int main(int argc, char *argv[]) {
     //}
     std::vector<G1> bases = random_group_elems<G1>(n);
 
+    if(argc > 3 && std::string(argv[3]) == "scaling") {
+        benchScaling(bases, exp, r);
+        return 0;
+    }
+
+    if(argc > 3 && std::string(argv[3]) == "fixed") {
+        benchFixedBase(bases, exp, r);
+        return 0;
+    }
+
     AveragingTimer tn("Multiexp rand base & exp");
     for(size_t i = 0; i < r; i++) {
         //loginfo << "Round #" << i+1 << endl;
@@ -54,5 +54,53 @@ int main(int argc, char *argv[]) {
 
     logperf << td << endl;
 
+    // e.g., an AMT proof for t = 2^8 has 9 pairings, plus one for the commitment
+    size_t m = 10;
+    std::vector<G1> xs = libpolycrypto::random_group_elems<G1>(m);
+    std::vector<G2> ys = libpolycrypto::random_group_elems<G2>(m);
+
+    AveragingTimer tp("Product of 10 pairings");
+    AveragingTimer tm("Multi-pairing of 10 pairs");
+    for(int i = 0; i < n; i++) {
+        tp.startLap();
+        auto prod = libpolycrypto::GT::one();
+        for(size_t j = 0; j < m; j++) {
+            prod = prod * libpolycrypto::ReducedPairing(xs[j], ys[j]);
+        }
+        tp.endLap();
+
+        tm.startLap();
+        auto multi = libpolycrypto::MultiPairing(xs, ys);
+        tm.endLap();
+
+        if(multi != prod)
+            throw std::runtime_error("Multi-pairing disagrees with the product of pairings");
+    }
+
+    logperf << tp << endl;
+    logperf << tm << endl;
+
+    // verifiers pair with the same G2 elements over and over (e.g., g2, g2^s, the accumulators)
+    std::vector<libpolycrypto::PreparedG2> prepared;
+    for(auto& y : ys) {
+        prepared.push_back(libpolycrypto::PreparedG2(y));
+    }
+    std::vector<const libpolycrypto::PreparedG2*> ysPrep;
+    for(auto& y : prepared) {
+        ysPrep.push_back(&y);
+    }
+
+    AveragingTimer tpp("Multi-pairing of 10 pairs (prepared G2)");
+    for(int i = 0; i < n; i++) {
+        tpp.startLap();
+        auto multi = libpolycrypto::MultiPairing(xs, ysPrep);
+        tpp.endLap();
+
+        if(multi != libpolycrypto::MultiPairing(xs, ys))
+            throw std::runtime_error("Prepared multi-pairing disagrees with the unprepared one");
+    }
+
+    logperf << tpp << endl;
+
     return 0;
 }
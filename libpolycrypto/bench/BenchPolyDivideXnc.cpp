@@ -34,6 +34,7 @@ int main(int argc, char *argv[])
 
     AveragingTimer 
         df("O(n) division      "),
+        ds("O(n) naive division"),
         dn("O(n log n) division");
     for(size_t i = 0; i < count; i++) {
 
@@ -65,7 +66,16 @@ int main(int argc, char *argv[])
         //poly_print(rhs); std::cout << endl;
         testAssertEqual(a, rhs); 
 
-        // Step 2: Do libntl division
+        // Step 2: Do the naive division, which shrinks the remainder one coefficient at a time
+        vector<Fr> qs, rs;
+        ds.startLap();
+        poly_divide_xnc_slow(a, b, qs, rs);
+        ds.endLap();
+
+        testAssertEqual(qs, q);
+        testAssertEqual(rs, r);
+
+        // Step 3: Do libntl division
         ZZ_pX za, zb, zq, zr;
         convLibffToNtl_slow(a, za);
         convLibffToNtl_slow(bf, zb);
@@ -82,6 +92,7 @@ int main(int argc, char *argv[])
     }
 
     logperf << df << endl;
+    logperf << ds << endl;
     logperf << dn << endl;
 
     return 0;
@@ -90,11 +90,7 @@ public:
         kateEval(point, q, r);
 
         // commit to quotient polynomial
-        auto proof = multiExp<G1>(
-            kpp.g1si.begin(),
-            kpp.g1si.begin() + static_cast<long>(q.size()),
-            q.begin(),
-            q.end());
+        auto proof = kpp.commit(q);
 
         return std::make_tuple(proof, r);
     }
@@ -108,18 +104,12 @@ public:
     
     void commitAndNizkPok() {
         // commit to polynomial using Kate commitments
-        // TODO: can be multithreaded
-        comm = multiExp<G1>(
-            kpp.g1si.begin(),
-            kpp.g1si.begin() + static_cast<long>(f_id.size()),
-            f_id.begin(),
-            f_id.end());
-        
+        comm = kpp.commit(f_id);
 
         if(isDkgPlayer) {
             // commit to f_id(0), needed for computing final PK
             Fr f0 = getSecret();
-            f0comm = f0 * G1::one();
+            f0comm = g1Exp(f0);
             // compute NIZKPoK for f_id(0)
             nizkpok = NizkPok::prove(G1::one(), f0, f0comm);
         }
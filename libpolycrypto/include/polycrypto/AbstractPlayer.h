@@ -67,11 +67,45 @@ public:
         // NOTE: KatePlayer will set this to do nothing, since evaluation happens "for free" as proofs are computed
         evaluate();
 
-        if(simulated) {
-            simulatedDealImpl();
-        } else {
-            // implementation-specific DKG dealing code
-            dealImpl();
+        finishDeal();
+    }
+
+    /**
+     * Has all these players deal, as if each one called deal(). The shares of all players that
+     * evaluate f_id(.) with an FFT (see evaluatesWithFFT()) are computed together with one batched
+     * FFT, which has a higher throughput than one FFT per player (e.g., when simulating many dealers).
+     */
+    static void dealAll(const std::vector<AbstractPlayer*>& players) {
+        std::vector<AbstractPlayer*> batched;
+        for(auto p : players) {
+            p->f_id = libpolycrypto::random_field_elems(p->params.t);
+
+            if(p->evaluatesWithFFT())
+                batched.push_back(p);
+            else
+                p->evaluate();
+        }
+
+        if(!batched.empty()) {
+            const DkgParams& params = batched[0]->params;
+            std::vector<std::vector<Fr>> polys, shares;
+            for(auto p : batched) {
+                if(p->params.N != params.N || p->params.n != params.n) {
+                    throw std::runtime_error("Players dealing together must have the same parameters");
+                }
+                polys.push_back(std::move(p->f_id));
+            }
+
+            libpolycrypto::fft_batch(polys, params.N, params.n, shares);
+
+            for(size_t b = 0; b < batched.size(); b++) {
+                batched[b]->f_id = std::move(polys[b]);
+                batched[b]->shares = std::move(shares[b]);
+            }
+        }
+
+        for(auto p : players) {
+            p->finishDeal();
         }
     }
 
@@ -91,6 +125,12 @@ public:
      */
     virtual void evaluate() = 0;
 
+    /**
+     * True if evaluate() is just an FFT of f_id(.) at the first n Nth roots of unity, which
+     * dealAll() can then batch across players.
+     */
+    virtual bool evaluatesWithFFT() const { return false; }
+
     /**
      * Implements the per-player verification in a DKG protocol.
      * Verifies this player's share of f_j(x) received from player j != id.
@@ -150,6 +190,19 @@ public:
     virtual void simulatedDealImpl() = 0;
 
     virtual void dealImpl() = 0;
+
+protected:
+    /**
+     * The rest of dealing, once f_id(.) has been picked and evaluated.
+     */
+    void finishDeal() {
+        if(simulated) {
+            simulatedDealImpl();
+        } else {
+            // implementation-specific DKG dealing code
+            dealImpl();
+        }
+    }
 };
 
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <polycrypto/PolyCrypto.h>
+#include <polycrypto/ScalarMult.h>
 #include <polycrypto/PolyOps.h>
 #include <polycrypto/BinaryTree.h>
 #include <polycrypto/KatePublicParameters.h>
@@ -244,8 +245,8 @@ protected:
 
             //loginfo << "Committing to acc of degree " << acc.size() - 1 << " at level " << k << endl;
 
-            if(acc.n > kpp.g2si.size() - 1) {
-                logerror << "At level " << k << ", need q-SDH params with q = " << acc.n << " but only have q = " << kpp.g2si.size() - 1 << endl;
+            if(!kpp.hasG2si(acc.n)) {
+                logerror << "At level " << k << ", need g2^{s^" << acc.n << "} but it was not loaded (q = " << kpp.q << ")" << endl;
                 throw std::runtime_error("Not enough public params to commit to accumulators");
             }
 
@@ -258,16 +259,16 @@ protected:
             // these accumulator polynomials that we leverage here
             G2& e = exp[j];
             if(e == G2::zero()) {
-                e = acc.c * G2::one();
+                e = g2Exp(acc.c);
                 exp[rev] = -e;
             } else {
-                assertEqual(e, acc.c * G2::one());
+                assertEqual(e, g2Exp(acc.c));
                 //logperf << "Re-using exp!" << endl;
             }
 
             // commit to a(x)  = x^n - w_N^j
             //     as g^{a(s)} = g^{s^n} * g^{-w_N^j}
-            tree[k][idx] = kpp.g2si[acc.n] + e;
+            tree[k][idx] = kpp.getG2si(acc.n) + e;
         });
     }
 
@@ -281,7 +282,7 @@ public:
             const auto& omegas = accs.getAllNthRootsOfUnity();
             testAssertEqual(
                 a,
-                kpp.g2si[monom.n] - omegas[libff::bitreverse(idx, numBits)] * G2::one());
+                kpp.getG2si(monom.n) - omegas[libff::bitreverse(idx, numBits)] * G2::one());
         });
     }
 };
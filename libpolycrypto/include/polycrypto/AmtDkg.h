@@ -7,6 +7,7 @@
 #include <polycrypto/AbstractKatePlayer.h>
 #include <polycrypto/KateDkg.h>
 #include <polycrypto/KatePublicParameters.h>
+#include <polycrypto/PointCompression.h>
 #include <polycrypto/RootsOfUnityEval.h>
 
 #include <libff/common/utils.hpp> // libff::bitreverse(idx, numBits)
@@ -25,6 +26,12 @@ using libpolycrypto::G1;
 using libpolycrypto::G2;
 using libpolycrypto::GT;
 using libpolycrypto::ReducedPairing;
+using libpolycrypto::MultiPairing;
+using libpolycrypto::MillerLoop;
+using libpolycrypto::FinalExponentiation;
+using libpolycrypto::Fqk;
+using libpolycrypto::PreparedG2;
+using libpolycrypto::preparedG2One;
 using libpolycrypto::RootsOfUnityEvaluation;
 using libpolycrypto::AuthRootsOfUnityEvaluation;
 using libpolycrypto::AuthAccumulatorTree;
@@ -60,6 +67,24 @@ public:
         return res;
     }
 
+public:
+    /**
+     * Serializes the proof as its compressed quotient commitments, for sending it to another player.
+     */
+    std::vector<unsigned char> toBytes() const {
+        return libpolycrypto::compressPoints(quoComms);
+    }
+
+    /**
+     * Deserializes a proof serialized with toBytes(). Throws std::runtime_error if any of
+     * the quotient commitments is malformed.
+     */
+    static AmtProof fromBytes(const std::vector<unsigned char>& buf) {
+        AmtProof pi;
+        pi.quoComms = libpolycrypto::decompressPoints<G1>(buf);
+        return pi;
+    }
+
 public:
     friend std::ostream& operator<<(std::ostream& out, const AmtProof& pi);
 };
@@ -69,10 +94,15 @@ public:
  */
 class AllAmtProofs {
 public:
+    const DkgParams& params;
     const AuthAccumulatorTree& authAccs;
     
     std::vector<G2> accPathForId;
 
+    // accPathForId and g2^s, prepared for pairing, since we pair with them for every dealer's proof
+    std::vector<PreparedG2> accPathForIdPrepared;
+    PreparedG2 g2toSPrepared;
+
     size_t n;       // the number of players
     size_t numBits; // the number of bits in N
     size_t proofNumLevels; // the # of nodes/levels in an AMT proof
@@ -85,7 +115,8 @@ public:
 
 public:
     AllAmtProofs(const DkgParams& params)
-        : authAccs(*params.authAccs), n(params.n), numBits(params.numBits), proofNumLevels(params.maxLevel + 1)
+        : params(params), authAccs(*params.authAccs), g2toSPrepared(authAccs.kpp.getG2toS()),
+          n(params.n), numBits(params.numBits), proofNumLevels(params.maxLevel + 1)
     {
     }
 
@@ -94,14 +125,26 @@ public:
 public:
     void addVerificationHelpers(size_t id) {
         // Fetch the accumulators needed to verify proofs for p(w_N^id)
-        accPathForId = authAccs.getPathFromLeaf(libff::bitreverse(id, numBits));
-        accPathForId.resize(proofNumLevels);
+        accPathForId = params.getAccumulatorPath(libff::bitreverse(id, numBits));
+
+        accPathForIdPrepared.clear();
+        for(auto& acc : accPathForId) {
+            accPathForIdPrepared.push_back(PreparedG2(acc));
+        }
     }
     
     void computeAllProofs(const RootsOfUnityEvaluation& eval, bool isSimulated) {
         authEval.reset(new AuthRootsOfUnityEvaluation(eval, authAccs.kpp, isSimulated));
     }
 
+    /**
+     * Like above, but evaluates p(x) as it computes the AMT, without keeping the whole multipoint
+     * evaluation tree in memory. Sets 'evals' to the evaluations p(w_N^id).
+     */
+    void computeAllProofs(const std::vector<Fr>& p, const AccumulatorTree& accs, size_t arity, bool isSimulated, std::vector<Fr>& evals) {
+        authEval.reset(new AuthRootsOfUnityEvaluation(p, accs, authAccs.kpp, isSimulated, evals, arity));
+    }
+
     void setZeroProof(const G1& proof) { f0proof = proof; }
 
     virtual const G1& getZeroProof() const { return f0proof; }
@@ -124,48 +167,48 @@ public:
      * Verifies an AMT proof for p(id) = val relative to polyComm.
      */
     bool verifyAtId(const G1& polyComm, const AmtProof& proof, const Fr& val) const {
-        G1 valComm = val * G1::one();
+        G1 valComm = g1Exp(val);
         logtrace << "Verifying at ID" << endl;
-        return verifyCommLogSized(polyComm, proof, valComm, accPathForId);
+        return verifyCommLogSized(polyComm, proof, valComm, accPathForIdPrepared);
     }
 
     /**
      * Verifies a normal Kate et al proof for valComm = g^p_j(0) where p_j is committed in polyComm.
      */
     bool verifyAtZero(const G1& polyComm, const G1& proof, const G1& valComm) const {
-        return verifyCommConstSized(polyComm, proof, valComm, authAccs.kpp.getG2toS());
+        return verifyCommConstSized(polyComm, proof, valComm, g2toSPrepared);
     }
 
     /**
      * Verifies an AMT proof for valComm = g^p_j(z), where p_j is committed in polyComm and z is a root of a(x), which is committed in accs.
      */
-    bool verifyCommLogSized(const G1& polyComm, const AmtProof& proof, const G1& valComm, const std::vector<G2>& accs) const {
-        GT lhs = ReducedPairing(polyComm - valComm, G2::one());
-        GT rhs = GT::one(); // GT uses multiplicative notation
-
+    bool verifyCommLogSized(const G1& polyComm, const AmtProof& proof, const G1& valComm, const std::vector<PreparedG2>& accs) const {
         testAssertEqual(accs.size(), proof.quoComms.size());
 
-        // TODO: could multithread this verification, but libff crashes in ReducedPairing for some reason
+        // checks e(g^{p(s)} / g^{p(z)}, g) = \prod_i e(g^{q_i(s)}, g^{a_i(s)}) as
+        // e(g^{p(z)} / g^{p(s)}, g) \prod_i e(g^{q_i(s)}, g^{a_i(s)}) = 1, with one final exponentiation
+        std::vector<G1> ps(1, valComm - polyComm);
+        std::vector<const PreparedG2*> qs(1, &preparedG2One());
+
         logtrace << "Path height: " << accs.size() << endl;
         for(size_t i = 0; i < accs.size(); i++) {
             logtrace << "q[" << i << "] = " << proof.quoComms[i] << endl;
-            logtrace << "a[" << i << "] = " << accs[i] << endl;
 
             // we remove g^{q(s)}) commitments from the proof when q(s) = 0
             testAssertFalse(proof.quoComms[i] == G1::zero());
 
-            rhs = rhs * ReducedPairing(proof.quoComms[i], accs[i]);
+            ps.push_back(proof.quoComms[i]);
+            qs.push_back(&accs[i]);
         }
 
-        return lhs == rhs;
+        return MultiPairing(ps, qs) == GT::one();
     }
 
     /**
      * Verifies a normal Kate et al proof for valComm = g^p_j(z), where p_j is committed in polyComm and z is committed in acc = g^{s - z}
      */
-    bool verifyCommConstSized(const G1& polyComm, const G1& proof, const G1& valComm, const G2& acc) const {
-        return ReducedPairing(polyComm - valComm, G2::one()) ==
-               ReducedPairing(proof, acc);
+    bool verifyCommConstSized(const G1& polyComm, const G1& proof, const G1& valComm, const PreparedG2& acc) const {
+        return MultiPairing({ valComm - polyComm, proof }, std::vector<const PreparedG2*>{ &preparedG2One(), &acc }) == GT::one();
     }
 };
 
@@ -173,10 +216,6 @@ public:
  * An AMT DKG/VSS player.
  */
 class MultipointPlayer : public AbstractKatePlayer<AllAmtProofs, AmtProof, MultipointPlayer> {
-public:
-    // for evaluating polynomial p(.) fast at all w_n^j, for j = 0, ..., n-1
-    std::unique_ptr<RootsOfUnityEvaluation> eval;
-
 public:
     MultipointPlayer(const DkgParams& params, const KatePublicParameters& kpp, size_t id, bool isSimulated, bool isDkgPlayer)
         : AbstractKatePlayer<AllAmtProofs, AmtProof, MultipointPlayer>(params, kpp, id, isSimulated, isDkgPlayer)
@@ -184,7 +223,7 @@ public:
         assertInclusiveRange(0, id, params.n - 1);
 
         // the accumulators in the multipoint evaluation tree have max degree N = 2^k, where N is the smallest value such that n <= N
-        if(kpp.g2si.size() < params.t - 1) {
+        if(kpp.q + 1 < params.t - 1) {
             throw std::runtime_error("Need more public parameters for the specified number of players (for accumulators)");
         }
 
@@ -194,26 +233,30 @@ public:
 
 public:
     /**
-     * Performs a multipoint evaluation at w_N^i for all i\in {0, ..., n-1} (instead of a classic DFT) since 
-     * we need to authenticate the resulting multipoint eval tree to obtain all AMT proofs.
+     * We need a multipoint evaluation at w_N^i for all i\in {0, ..., n-1} (instead of a classic DFT) since 
+     * we need to authenticate the resulting multipoint eval tree to obtain all AMT proofs. So, like in
+     * Kate et al's scheme, we get the evals for "free" while computing the proofs, one level of the
+     * tree at a time (see AuthRootsOfUnityEvaluation), which never stores the whole tree.
      */
     virtual void evaluate() {
-        eval.reset(new RootsOfUnityEvaluation(f_id, *params.accs));
-        shares = eval->getEvaluations();
-        assertEqual(shares.size(), params.n);
     }
 
-    virtual void computeRealProofs() {
-        assertNotNull(eval);
+    /**
+     * Computes the shares and the AMT proofs for them.
+     */
+    void evaluateAndComputeAllProofs() {
         assertNotNull(allProofs);
 
         auto proofs = dynamic_cast<AllAmtProofs*>(allProofs.get());
-        proofs->computeAllProofs(*eval, isSimulated());
+        proofs->computeAllProofs(f_id, *params.accs, params.arity, isSimulated(), shares);
+        assertEqual(shares.size(), params.n);
+    }
 
-        eval.reset(nullptr); // don't need the multipoint eval after
+    virtual void computeRealProofs() {
+        evaluateAndComputeAllProofs();
 
         // compute constant-sized proof for p(0)
-        proofs->setZeroProof(
+        allProofs->setZeroProof(
             std::get<0>(
                 kateProve(Fr::zero())
             )
@@ -221,20 +264,14 @@ public:
     }
 
     virtual void computeSimulatedProofs() {
-        assertNotNull(eval);
-        assertNotNull(allProofs);
-
-        auto proofs = dynamic_cast<AllAmtProofs*>(allProofs.get());
-        proofs->computeAllProofs(*eval, isSimulated());
-
-        eval.reset(nullptr); // don't need the multipoint eval after
+        evaluateAndComputeAllProofs();
 
         // compute constant-sized proof for p(0)
         Fr s = kpp.getTrapdoor();
         Fr pOfS = libfqfft::evaluate_polynomial(f_id.size(), f_id, s);
-        assertEqual(comm, pOfS * G1::one());
+        assertEqual(comm, g1Exp(pOfS));
         allProofs->setZeroProof(
-            ( (pOfS - f_id[0])*s.inverse() ) * G1::one());
+            g1Exp( (pOfS - f_id[0])*s.inverse() ));
     }
 
     // always verify t correct shares with memoization
@@ -242,28 +279,30 @@ public:
     virtual bool verifySharesReconstruction(const std::vector<size_t>& subset, bool fastTrack) {
         assertNotNull(params.authAccs);
         size_t numBits = params.numBits;
-        size_t proofNumLevels = params.maxLevel + 1;
 
         // NOTE: We verify as e(g^p(s), g) = [ \prod_w e(g^q_w(s), g^a_w(s)) ] e(g,g)^p(i)
-        // because computing e(g,g)^p(i) is faster than computing e(g^p(s)/g^p(i), g)
-
-        // memoizes e(g^q_w(s), g^a_w(s)) by w = [level][idx]
-        class PairingMemo {
-        public:
-            boost::unordered_map<std::pair<size_t, size_t>, GT> m;
-
-        public:
-            GT& at(size_t level, size_t idx) {
-                return m[std::make_pair(level, idx)];
-            }
-        } memo;
-        GT gtDefault;
-        assertEqual(memo.at(0,0), gtDefault);
+        // because computing e(g,g)^p(i) is faster than computing e(g^p(s)/g^p(i), g).
+        // We move e(g^p(s), g) to the RHS as e(g^{-p(s)}, g), so that all pairings for a proof
+        // share a single final exponentiation (see MultiPairing()).
+
+        // memoizes the Miller loop of e(g^q_w(s), g^a_w(s)) by w = [level][idx]
+        boost::unordered_map<std::pair<size_t, size_t>, Fqk> memo;
+
+        // caches the prepared accumulators g^a_w(s) by w = [level][idx], since the ones near the
+        // root are on the path of many players
+        boost::unordered_map<std::pair<size_t, size_t>, PreparedG2> preparedAccs;
+        auto prepareAcc = [&preparedAccs](size_t level, size_t idx, const G2& acc) -> const PreparedG2& {
+            auto key = std::make_pair(level, idx);
+            auto it = preparedAccs.find(key);
+            if(it == preparedAccs.end())
+                it = preparedAccs.emplace(key, PreparedG2(acc)).first;
+            return it->second;
+        };
 
         // Step 1: Whether fast-track or not, use memoization to verify t proofs
         
-        // so, compute e(g^p(s),g) LHS
-        GT lhs = ReducedPairing(comm, G2::one());
+        // so, compute the Miller loop of e(g^{-p(s)},g)
+        Fqk negLhs = MillerLoop(-comm, preparedG2One());
 
         auto postMortem = [](const std::vector<G2>& accs, const std::vector<G1>& quo) {
             loginfo << "Path lengths: " << accs.size() << " and " << quo.size() << endl;
@@ -277,46 +316,45 @@ public:
             }
         };
 
-        // ...and then compute [ \prod_w e(g^q_w(s), g^a_w(s)) ] e(g,g)^p(i) RHS
-        std::vector<std::tuple<size_t, size_t, GT>> pairings;
+        // ...and then compute e(g^{-p(s)}, g) [ \prod_w e(g^q_w(s), g^a_w(s)) ] e(g,g)^p(i) RHS, which should be 1
+        std::vector<std::tuple<size_t, size_t, Fqk>> loops;
         for(size_t pid : subset) {
             size_t i = libff::bitreverse(pid, numBits);
 
-            GT rhs = GT::one();
-            auto accs = params.authAccs->getPathFromLeaf(i);
-            accs.resize(proofNumLevels);
+            Fqk f = negLhs;
+            auto accs = params.getAccumulatorPath(i);
             auto quo = allProofs->getPlayerProof(pid).quoComms;
             testAssertEqual(accs.size(), quo.size());
 
-            pairings.clear();
+            loops.clear();
             for(size_t k = 0; k < quo.size(); k++) {
                 // don't pair e(g^{q(s)}, g^{a(s)}) when q(s) = 0
                 testAssertFalse(quo[k] == G1::zero());
 
-                // check if we've already memoized this pairing and, if not, queue it for memoizing
+                // check if we've already memoized this Miller loop and, if not, queue it for memoizing
                 // if the proof verifies
-                GT& pair = memo.at(k, i);
-                if(pair == gtDefault) {
-                    pairings.push_back(
+                auto it = memo.find(std::make_pair(k, i));
+                if(it == memo.end()) {
+                    loops.push_back(
                         std::make_tuple(
                             k, i,
-                            ReducedPairing(quo[k], accs[k])));
+                            MillerLoop(quo[k], prepareAcc(k, i, accs[k]))));
 
-                    rhs = rhs * std::get<2>(pairings.back());
+                    f = f * std::get<2>(loops.back());
                 } else {
-                    rhs = rhs * pair;
+                    f = f * it->second;
                 }
 
                 // move up a level
-                i /= 2;
+                i /= params.arity;
             }
 
-            rhs = rhs * (params.gt ^ shares[pid]);
+            GT rhs = FinalExponentiation(f) * (params.gt ^ shares[pid]);
 
-            if(lhs == rhs) {
-                // if the proof verified, then memoize its pairings for later
-                for(auto& pair : pairings) {
-                    memo.at(std::get<0>(pair), std::get<1>(pair)) = std::get<2>(pair);
+            if(rhs == GT::one()) {
+                // if the proof verified, then memoize its Miller loops for later
+                for(auto& loop : loops) {
+                    memo[std::make_pair(std::get<0>(loop), std::get<1>(loop))] = std::get<2>(loop);
                 }
             } else {
                 logerror << "AMT proof of player " << pid << " did not verify during reconstruction" << endl;
@@ -337,7 +375,6 @@ public:
                 last.push_back(params.n);
             }
 
-            lhs = ReducedPairing(comm, G2::one());
             // joins the two ranges into one (efficiently, I hope?)
             auto range = boost::join(subset, last);
 #ifndef NDEBUG
@@ -350,22 +387,27 @@ public:
 #endif
                     size_t leafIdx = libff::bitreverse(pid, numBits);
 
-                    GT rhs = GT::one();
-                    auto accs = params.authAccs->getPathFromLeaf(leafIdx);
-                    accs.resize(proofNumLevels);
+                    auto accs = params.getAccumulatorPath(leafIdx);
                     auto quo = allProofs->getPlayerProof(pid).quoComms;
                     testAssertEqual(accs.size(), quo.size());
 
+                    std::vector<G1> ps(1, -comm);
+                    std::vector<const PreparedG2*> qs(1, &preparedG2One());
+                    size_t i = leafIdx;
                     for(size_t k = 0; k < quo.size(); k++) {
                         // don't pair e(g^{q(s)}, g^{a(s)}) when q(s) = 0
                         testAssertFalse(quo[k] == G1::zero());
 
-                        rhs = rhs * ReducedPairing(quo[k], accs[k]);
+                        ps.push_back(quo[k]);
+                        qs.push_back(&prepareAcc(k, i, accs[k]));
+
+                        // move up a level
+                        i /= params.arity;
                     }
 
-                    rhs = rhs * (params.gt ^ shares[pid]);
+                    GT rhs = MultiPairing(ps, qs) * (params.gt ^ shares[pid]);
 
-                    if(lhs != rhs) {
+                    if(rhs != GT::one()) {
                         logerror << "AMT proof of player " << pid << " did not verify during reconstruction" << endl; 
                         postMortem(accs, quo);
                         return false;
@@ -3,6 +3,7 @@
 #include <polycrypto/PolyCrypto.h>
 
 #include <vector>
+#include <algorithm>
 #include <utility>
 #include <functional>
 #include <cmath>
@@ -19,9 +20,88 @@ using namespace std;
 namespace libpolycrypto {
 
 /**
- * Base class used to represent a full binary tree.
+ * Throws std::runtime_error if the arity of a tree is not a power of two greater than one and
+ * returns it otherwise, so it can be checked in initializer lists before it is used (e.g., in a
+ * division by log2(arity)).
+ */
+inline size_t checkArity(size_t arity) {
+    if(arity < 2 || !Utils::isPowerOfTwo(arity)) {
+        throw std::runtime_error("The arity of a tree must be a power of two greater than one");
+    }
+    return arity;
+}
+
+/**
+ * The nodes of a tree, stored level by level in one contiguous array: the leaves (level 0) first,
+ * then level 1, and so on, up to the root(s). levels[k][i] is the ith node at level k, as with a
+ * vector of vectors, but the whole tree is a single allocation (and a single free), and the path
+ * from a leaf to the root is a forward walk through the array, one level at a time.
+ */
+template<typename TreeNode>
+class TreeLevels {
+public:
+    /**
+     * A view of the nodes at one level.
+     */
+    template<typename T>
+    class Level {
+    protected:
+        T * first;
+        size_t len;
+
+    public:
+        Level(T * first, size_t len) : first(first), len(len) {}
+
+    public:
+        size_t size() const { return len; }
+        T& operator[](size_t i) const { return first[i]; }
+        T * begin() const { return first; }
+        T * end() const { return first + len; }
+    };
+
+protected:
+    std::vector<TreeNode> nodes;
+    std::vector<size_t> offsets;    // level k is nodes[offsets[k], offsets[k+1])
+
+public:
+    /**
+     * Allocates numLevels levels, with numLeaves nodes at level 0 and 'arity' times fewer at every next level.
+     */
+    void allocate(size_t numLeaves, size_t numLevels, size_t arity = 2) {
+        offsets.resize(numLevels + 1);
+        offsets[0] = 0;
+        size_t width = numLeaves;
+        for(size_t k = 0; k < numLevels; k++) {
+            offsets[k + 1] = offsets[k] + width;
+            width /= arity;
+        }
+
+        nodes.clear();
+        nodes.resize(offsets[numLevels]);
+    }
+
+    /**
+     * Returns the number of levels.
+     */
+    size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+    Level<TreeNode> operator[](size_t k) {
+        return Level<TreeNode>(nodes.data() + offsets[k], offsets[k + 1] - offsets[k]);
+    }
+
+    Level<const TreeNode> operator[](size_t k) const {
+        return Level<const TreeNode>(nodes.data() + offsets[k], offsets[k + 1] - offsets[k]);
+    }
+
+    Level<TreeNode> back() { return operator[](size() - 1); }
+    Level<const TreeNode> back() const { return operator[](size() - 1); }
+};
+
+/**
+ * Base class used to represent a full binary tree or, more generally, a full q-ary tree where
+ * q = 2^b is the tree's arity: the children of node i at level k are nodes q*i, ..., q*i + q - 1
+ * at level k - 1.
  * Leaves are at level 0.
- * TODO: Should change to q-ary tree (for time/space trade-off)
  */
 template<typename TreeNode>
 class BinaryTree {
@@ -29,7 +109,10 @@ public:
     /** 
      * tree[k][i] is the ith node at level k in the tree (k = 0 is the last level with leaves)
      */
-    vector<vector<TreeNode>> tree;
+    TreeLevels<TreeNode> tree;
+
+protected:
+    size_t arity = 2;   // the number of children of every internal node
 
     /**
      * WARNING: Lambdas that 'capture' variables cannot be passed as arguments where a function pointer is expected. 
@@ -54,19 +137,22 @@ public:
      * Allocates a tree capable of storing the specified # of leaves.
      *
      * @param maxLevel  instead of creating a full tree with a root node, stops creating nodes past   
-     *                  this level, resulting in a forest of trees, each with 2^maxLevel leaves
+     *                  this level, resulting in a forest of trees, each with arity^maxLevel leaves
+     * @param arity     the number of children of every internal node, a power of two
      */
-    void allocateTree(size_t numLeaves, size_t maxLevel) {
+    void allocateTree(size_t numLeaves, size_t maxLevel, size_t arity = 2) {
         testAssertIsPowerOfTwo(numLeaves);
+        checkArity(arity);
 
         /**
          * Height of tree in # of levels, where levels are counted as nodes (not as edges)
          * For example, when numLeaves = 2, height is 2.
          * Or, when numLeaves = 3 or 4, height is 3.
          * Or, when numLeaves = 5, 6, 7 or 8, height is 4.
-         * In general, height is ceil(log2(numLeaves)) + 1.
+         * In general, height is ceil(log2(numLeaves)) + 1, or floor(log_q(numLeaves)) + 1 for a q-ary tree.
          */
-        size_t maxHeight = static_cast<size_t>(Utils::log2ceil(numLeaves) + 1);
+        size_t logArity = Utils::log2floor(arity);
+        size_t maxHeight = static_cast<size_t>(Utils::log2ceil(numLeaves)) / logArity + 1;
         if(maxLevel >= maxHeight) {
             logerror << "Cannot create tree with max level # " << maxLevel << endl;
             logerror << "Max possible level # (starting at 0) for tree with " << numLeaves << " leaves is " << maxHeight - 1 << endl;
@@ -74,20 +160,20 @@ public:
         }
 
         size_t numLevels = maxLevel + 1;
-        tree.resize(numLevels);
-        tree[0].resize(numLeaves);
-        
-        for(size_t k = 1; k < numLevels; k++) {
-            tree[k].resize(tree[k-1].size() / 2);
-        }
+        this->arity = arity;
+        tree.allocate(numLeaves, numLevels, arity);
         
         // Check the root level has size 1
-        assertEqual(tree[maxLevel].size(), numLeaves / (1u << maxLevel));
+        assertEqual(tree[maxLevel].size(), numLeaves >> (logArity * maxLevel));
     }
 
     size_t getNumLeaves() const {
         return tree[0].size();
     }
+
+    size_t getArity() const {
+        return arity;
+    }
     
     /**
      * Returns the number of levels in the tree (e.g., a one-node tree has 1 level).
@@ -102,21 +188,23 @@ public:
      */
     std::vector<TreeNode> getPathFromLeaf(size_t leafIdx) const {
         std::vector<TreeNode> nodes;
+        nodes.reserve(tree.size());
         logtrace << "Fetching path for " << leafIdx << endl;
-        for(auto& lvl : tree) {
+        for(size_t k = 0; k < tree.size(); k++) {
+            auto lvl = tree[k];
             assertValidIndex(leafIdx, lvl);
 
             logtrace << "Pushing one node" << endl;
             nodes.push_back(lvl[leafIdx]);
 
-            leafIdx /= 2;
+            leafIdx /= arity;
         }
         return nodes;
     }
     // TODO: maybe add a pathExec() that executes a function for each node on the path? 
 
     /**
-     * Pre-order traversal of the tree: (root, left child, right child)
+     * Pre-order traversal of the tree: (root, first child, ..., last child)
      * Used when computing quotients in the tree and when committing to polynomials in the tree.
      */
     void traversePreorder(const ComputeNodeFunc& func) {
@@ -131,14 +219,55 @@ public:
     void traversePreorder(size_t k, size_t idx, const ComputeNodeFunc& func) {
         func(k, idx);
         
-        // if we haven't reached the last level yet,
+        // if we haven't reached the last level yet, go to the children (and, if you can, to all of them)
         if(k > 0) {
-            traversePreorder(k - 1, 2*idx, func);         // go left
-            if(2*idx + 1 < tree[k - 1].size()) {          // and, if you can,
-                traversePreorder(k - 1, 2*idx + 1, func); // go right
+            for(size_t c = arity*idx; c < std::min(arity*idx + arity, tree[k - 1].size()); c++) {
+                traversePreorder(k - 1, c, func);
             }
         }
     }
+
+    /**
+     * Like traversePreorder(), but in parallel: once a node is computed, its children's subtrees are
+     * independent, so each one becomes an OpenMP task that idle threads can pick up. Subtrees
+     * rooted at level 'serialLevel' or below are traversed serially by a single task, so tasks
+     * are not too small to pay for themselves.
+     *
+     * WARNING: func must be safe to call concurrently on nodes that are not ancestors of one another.
+     */
+    void traversePreorderParallel(const ComputeNodeFunc& func, size_t serialLevel) {
+        assertStrictlyGreaterThan(tree.size(), 0);
+
+        size_t rootLevel = tree.size() - 1;
+        size_t numRoots =  tree.back().size();
+#ifdef USE_MULTITHREADING
+#pragma omp parallel
+#pragma omp single
+#endif
+        for(size_t i = 0; i < numRoots; i++) {
+#ifdef USE_MULTITHREADING
+#pragma omp task shared(func)
+#endif
+            traversePreorderParallel(rootLevel, i, func, serialLevel);
+        }
+        // NOTE: all tasks are done by the end of the parallel region
+    }
+
+    void traversePreorderParallel(size_t k, size_t idx, const ComputeNodeFunc& func, size_t serialLevel) {
+        if(k <= serialLevel) {
+            traversePreorder(k, idx, func);
+            return;
+        }
+
+        func(k, idx);
+
+        for(size_t c = arity*idx; c < std::min(arity*idx + arity, tree[k - 1].size()); c++) {
+#ifdef USE_MULTITHREADING
+#pragma omp task shared(func)
+#endif
+            traversePreorderParallel(k - 1, c, func, serialLevel);
+        }
+    }
 };
 
 } // end of namespace libpolycrypto
@@ -4,6 +4,7 @@
 
 #include <polycrypto/PolyCrypto.h>
 #include <polycrypto/AccumulatorTree.h>
+#include <polycrypto/ScalarMult.h>
 
 #include <xutils/Utils.h>
 
@@ -14,6 +15,8 @@ using libpolycrypto::G1;
 using libpolycrypto::G2;
 using libpolycrypto::GT;
 using libpolycrypto::ReducedPairing;
+using libpolycrypto::g1Exp;
+using libpolycrypto::g2Exp;
 using libpolycrypto::AccumulatorTree;
 using libpolycrypto::AuthAccumulatorTree;
 
@@ -33,7 +36,8 @@ public:
     size_t n;               // the total # of players
     size_t N;               // the smallest N = 2^k such that n <= N
     size_t numBits;         // the number of bits in a player ID: i.e., log2(N)
-    size_t maxLevel;        // the max level in a accumulator/roots-of-unity eval tree (leaves are level 0)
+    size_t arity;           // the number of children of every node in an AMT (a power of two)
+    size_t maxLevel;        // the max level in a roots-of-unity eval tree with this arity (leaves are level 0)
 
     std::unique_ptr<AccumulatorTree> accs;          // needed for AMT VSS/DKG
     const AuthAccumulatorTree * authAccs;  // needed for KZG/AMT VSS/DKG
@@ -42,12 +46,17 @@ public:
     GT gt;                  // the generator of GT
 
 public:
-    DkgParams(size_t t, size_t n, bool needsAccs)
+    /**
+     * @param arity     the arity of the AMTs: a higher arity gives shorter proofs, which take fewer
+     *                  pairings to verify, but bigger quotients, which take longer to commit to
+     */
+    DkgParams(size_t t, size_t n, bool needsAccs, size_t arity = 2)
         : t(t), 
           n(n),
           N(Utils::smallestPowerOfTwoAbove(n)),
           numBits(Utils::log2ceil(n)),
-          maxLevel(Utils::log2floor(t-1)),
+          arity(libpolycrypto::checkArity(arity)),
+          maxLevel(Utils::log2floor(t-1) / Utils::log2floor(this->arity)),
           accs(needsAccs ? new AccumulatorTree(n) : nullptr),
           authAccs(nullptr),
           omegas(needsAccs ? accs->getAllNthRootsOfUnity() : libpolycrypto::get_all_roots_of_unity(N)),
@@ -78,6 +87,24 @@ public:
         auto leafIdx = libff::bitreverse(playerId, numBits);
         return authAccs->getLeaf(leafIdx);
     }
+
+    /**
+     * Returns the commitments to the accumulators on the path from the specified leaf up to level
+     * maxLevel, which are needed to verify AMT proofs for that leaf. Level k of an AMT with arity
+     * q = 2^b is level bk of the (binary) AuthAccumulatorTree.
+     */
+    std::vector<G2> getAccumulatorPath(size_t leafIdx) const {
+        assertNotNull(authAccs);
+        auto path = authAccs->getPathFromLeaf(leafIdx);
+        size_t logArity = Utils::log2floor(arity);
+
+        std::vector<G2> accPath(maxLevel + 1);
+        for(size_t k = 0; k <= maxLevel; k++) {
+            assertValidIndex(k * logArity, path);
+            accPath[k] = path[k * logArity];
+        }
+        return accPath;
+    }
 };
 
 
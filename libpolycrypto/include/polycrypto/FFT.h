@@ -0,0 +1,481 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <libff/algebra/fields/field_utils.hpp> // get_root_of_unity
+#include <libff/common/utils.hpp>               // bitreverse
+
+#include <xassert/XAssert.h>
+#include <xutils/Utils.h>
+
+namespace libpolycrypto {
+
+/**
+ * FFTs of size up to this many field elements (128 KiB for a 256-bit field) run all their stages
+ * on one block before moving to the next one, so that the block stays in cache. Bigger FFTs first
+ * do all the stages that fit within such blocks, block by block, and only then the remaining,
+ * wider stages over the whole array.
+ */
+const size_t FFTBlockSize = 1u << 12;
+
+/**
+ * FFTs smaller than this are not worth splitting across threads.
+ */
+const size_t FFTParallelThreshold = 1u << 10;
+
+/**
+ * The twiddle factors for radix-2 FFTs, laid out stage by stage: tw[m - 1 + j] = w_{2m}^j, for
+ * m = 1, 2, 4, ..., N/2 and j < m, where w_{2m} = libff::get_root_of_unity(2m). This way, each
+ * stage reads its twiddles contiguously rather than with a stride.
+ *
+ * Since the twiddles for one stage do not depend on N, the table for a smaller N is a prefix of
+ * the one for a bigger N, so we only cache the one for the biggest N asked for so far.
+ */
+template<class FieldT>
+class FFTTwiddles {
+public:
+    static std::shared_ptr<const std::vector<FieldT>> get(size_t N) {
+        static std::mutex mutex;
+        static std::shared_ptr<const std::vector<FieldT>> cached;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if(cached == nullptr || cached->size() + 1 < N) {
+            cached = compute(N);
+        }
+        return cached;
+    }
+
+protected:
+    static std::shared_ptr<const std::vector<FieldT>> compute(size_t N) {
+        assertTrue(Utils::isPowerOfTwo(N));
+
+        const size_t chunkSize = 1024;
+        auto tw = std::make_shared<std::vector<FieldT>>(N > 1 ? N - 1 : 0);
+        for(size_t m = 1; m < N; m *= 2) {
+            FieldT w = libff::get_root_of_unity<FieldT>(2*m);
+            FieldT * stage = tw->data() + m - 1;
+
+            // every chunk starts from w^start, so that chunks can be filled in in parallel
+            size_t numChunks = (m + chunkSize - 1) / chunkSize;
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for if(numChunks > 1)
+#endif
+            for(size_t c = 0; c < numChunks; c++) {
+                size_t start = c * chunkSize, end = std::min(start + chunkSize, m);
+                stage[start] = w ^ static_cast<unsigned long>(start);
+                for(size_t j = start + 1; j < end; j++) {
+                    stage[j] = stage[j - 1] * w;
+                }
+            }
+        }
+
+        return tw;
+    }
+};
+
+namespace internal {
+
+/*
+ * All the passes below work on x[0, len) as an array of len rows of 'lanes' field elements each,
+ * stored contiguously: x[i * lanes + l] is the ith element of the lth FFT. Every butterfly is
+ * applied to all the lanes of its two rows, with the same twiddle, so a batch of FFTs (see
+ * fft_batch) loads each twiddle once and has independent work in its innermost loop.
+ * A single FFT is just one lane.
+ */
+
+/**
+ * One radix-2 DIT stage with half-size m over x[0, len): for every block of 2m elements and j < m,
+ * (x_j, x_{j+m}) <- (x_j + w_{2m}^j x_{j+m}, x_j - w_{2m}^j x_{j+m}).
+ */
+template<class FieldT>
+void fft_radix2_pass(FieldT * x, size_t len, size_t lanes, size_t m, const FieldT * tw, bool parallel) {
+    const FieldT * w = tw + m - 1;
+    const size_t numBlocks = len / (2*m);
+    const size_t hop = m * lanes;
+    (void)parallel;
+
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for collapse(2) if(parallel)
+#endif
+    for(size_t b = 0; b < numBlocks; b++) {
+        for(size_t j = 0; j < m; j++) {
+            FieldT * y = x + (b * 2*m + j) * lanes;
+            for(size_t l = 0; l < lanes; l++) {
+                FieldT t = w[j] * y[l + hop];
+                y[l + hop] = y[l] - t;
+                y[l] = y[l] + t;
+            }
+        }
+    }
+}
+
+/**
+ * The radix-2 DIT stages with half-sizes m and 2m over x[0, len), done together in one pass
+ * over the data: every group of four elements x_j, x_{j+m}, x_{j+2m}, x_{j+3m} goes through
+ * both stages while in registers.
+ */
+template<class FieldT>
+void fft_radix4_pass(FieldT * x, size_t len, size_t lanes, size_t m, const FieldT * tw, bool parallel) {
+    const FieldT * w1 = tw + m - 1;      // w_{2m}^j
+    const FieldT * w2 = tw + 2*m - 1;    // w_{4m}^j, and w_{4m}^{j+m} at j+m
+    const size_t numBlocks = len / (4*m);
+    const size_t hop = m * lanes;
+    (void)parallel;
+
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for collapse(2) if(parallel)
+#endif
+    for(size_t b = 0; b < numBlocks; b++) {
+        for(size_t j = 0; j < m; j++) {
+            FieldT * y = x + (b * 4*m + j) * lanes;
+            for(size_t l = 0; l < lanes; l++) {
+                FieldT * z = y + l;
+
+                // stage m, on (z_0, z_m) and (z_{2m}, z_{3m})
+                FieldT t1 = w1[j] * z[hop], t3 = w1[j] * z[3*hop];
+                FieldT b0 = z[0] + t1, b1 = z[0] - t1;
+                FieldT b2 = z[2*hop] + t3, b3 = z[2*hop] - t3;
+
+                // stage 2m, on (b_0, b_2) and (b_1, b_3)
+                FieldT c2 = w2[j] * b2, c3 = w2[j + m] * b3;
+                z[0]     = b0 + c2;
+                z[2*hop] = b0 - c2;
+                z[hop]   = b1 + c3;
+                z[3*hop] = b1 - c3;
+            }
+        }
+    }
+}
+
+/**
+ * Does the stages with half-sizes mFirst, 2 mFirst, ..., mLast over x[0, len), two at a time.
+ */
+template<class FieldT>
+void fft_stages(FieldT * x, size_t len, size_t lanes, size_t mFirst, size_t mLast, const FieldT * tw, bool parallel) {
+    if(mFirst > mLast)
+        return;
+
+    size_t numStages = Utils::log2floor(mLast / mFirst) + 1;
+    size_t m = mFirst;
+    if(numStages % 2 == 1) {
+        fft_radix2_pass(x, len, lanes, m, tw, parallel);
+        m *= 2;
+    }
+
+    for(; m <= mLast; m *= 4) {
+        fft_radix4_pass(x, len, lanes, m, tw, parallel);
+    }
+}
+
+/**
+ * A radix-2 DIT stage with half-size m > numOut/2, when only the first numOut outputs of the FFT
+ * are needed: every block then only needs its first numOut outputs, so butterflies that would
+ * only produce later outputs are skipped.
+ */
+template<class FieldT>
+void fft_pruned_pass(FieldT * x, size_t len, size_t lanes, size_t m, size_t numOut, const FieldT * tw, bool parallel) {
+    const FieldT * w = tw + m - 1;
+    const size_t numBlocks = len / (2*m);
+    const size_t numButterflies = std::min(numOut, m);
+    const size_t hop = m * lanes;
+    (void)parallel;
+
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for collapse(2) if(parallel)
+#endif
+    for(size_t b = 0; b < numBlocks; b++) {
+        for(size_t j = 0; j < numButterflies; j++) {
+            FieldT * y = x + (b * 2*m + j) * lanes;
+            for(size_t l = 0; l < lanes; l++) {
+                FieldT t = w[j] * y[l + hop];
+                if(j + m < numOut)
+                    y[l + hop] = y[l] - t;
+                y[l] = y[l] + t;
+            }
+        }
+    }
+}
+
+/**
+ * Runs the stages with half-sizes mStart, 2 mStart, ..., N/2 of 'lanes' interleaved FFTs of
+ * size N on the bit-reversed x (see fft_inplace), but only computes their first numOut outputs.
+ * Stages whose blocks are no bigger than numOut are done in full; the remaining ones are pruned
+ * (see fft_pruned_pass).
+ */
+template<class FieldT>
+void fft_bitreversed(FieldT * x, size_t N, size_t lanes, size_t mStart, size_t numOut) {
+    if(N < 2)
+        return;
+
+    auto twiddles = FFTTwiddles<FieldT>::get(N);
+    const FieldT * tw = twiddles->data();
+    const bool parallel = N * lanes >= FFTParallelThreshold;
+
+    // the last stage that is done in full: i.e., the largest m with 2m <= min(numOut, N)
+    numOut = std::min(numOut, N);
+    const size_t mFull = numOut == 0 ? 0 : (static_cast<size_t>(1) << Utils::log2floor(numOut)) / 2;
+
+    if(mStart <= mFull) {
+        // first, the stages that fit within a block of FFTBlockSize elements, one block at a time
+        const size_t rowsPerBlock = static_cast<size_t>(1) << Utils::log2floor(std::max<size_t>(FFTBlockSize / lanes, 1));
+        const size_t B = std::min(N, rowsPerBlock);
+        const size_t numBlocks = N / B;
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for if(parallel && numBlocks > 1)
+#endif
+        for(size_t b = 0; b < numBlocks; b++) {
+            fft_stages(x + b * B * lanes, B, lanes, mStart, std::min(B/2, mFull), tw, numBlocks == 1 && parallel);
+        }
+
+        // then, the wider stages over the whole array
+        fft_stages(x, N, lanes, std::max(B, mStart), mFull, tw, parallel);
+    }
+
+    for(size_t m = std::max(2*mFull, mStart); m < N; m *= 2) {
+        fft_pruned_pass(x, N, lanes, m, numOut, tw, parallel);
+    }
+}
+
+/**
+ * Turns the FFT of a (of size N) into its inverse FFT: since w^{-i} = w^{N-i}, the ith output of
+ * the inverse is the (N-i)th one of the FFT, divided by N.
+ */
+template<class FieldT>
+void ifft_from_fft(std::vector<FieldT>& a) {
+    const size_t N = a.size();
+    if(N < 2)
+        return;
+
+    std::reverse(a.begin() + 1, a.end());
+
+    const FieldT invN = FieldT(static_cast<long>(N)).inverse();
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for if(N >= FFTParallelThreshold)
+#endif
+    for(size_t i = 0; i < N; i++) {
+        a[i] *= invN;
+    }
+}
+
+/**
+ * Sets a[i] = a[i] * g^i, for all i.
+ */
+template<class FieldT>
+void scale_by_powers(std::vector<FieldT>& a, const FieldT& g) {
+    FieldT gi = FieldT::one();
+    for(size_t i = 0; i < a.size(); i++) {
+        a[i] *= gi;
+        gi *= g;
+    }
+}
+
+} // end of namespace internal
+
+/**
+ * Replaces a (of size N = 2^k) by its FFT: i.e., by a(\omega^i) for i = 0, ..., N-1, where \omega
+ * is libff's primitive Nth root of unity. Does the bit-reversal permutation in place, and then
+ * the radix-2 stages two at a time, with cached twiddles (see FFTTwiddles), cache blocking
+ * (see FFTBlockSize) and, if enabled, OpenMP.
+ */
+template<class FieldT>
+void fft_inplace(std::vector<FieldT>& a) {
+    const size_t N = a.size();
+    if(!Utils::isPowerOfTwo(N))
+        throw std::runtime_error("FFT size must be a power of two");
+
+    const size_t logN = Utils::log2floor(N);
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for if(N >= FFTParallelThreshold)
+#endif
+    for(size_t i = 0; i < N; i++) {
+        size_t r = libff::bitreverse(i, logN);
+        if(i < r)
+            std::swap(a[i], a[r]);
+    }
+
+    internal::fft_bitreversed(a.data(), N, 1, 1, N);
+}
+
+/**
+ * Sets vals to the FFT of size N of p: i.e., vals[i] = p(\omega^i) for i = 0, ..., N-1.
+ * Copies p into vals already in bit-reversed order, rather than copying it and then permuting it.
+ */
+template<class FieldT>
+void fft(const std::vector<FieldT>& p, size_t N, std::vector<FieldT>& vals) {
+    if(!Utils::isPowerOfTwo(N))
+        throw std::runtime_error("FFT size must be a power of two");
+    if(N < p.size())
+        throw std::runtime_error("N has to be greater than polynomial degree");
+
+    if(&p == &vals) {
+        vals.resize(N, FieldT::zero());
+        fft_inplace(vals);
+        return;
+    }
+
+    const size_t logN = Utils::log2floor(N);
+    vals.resize(N);
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for if(N >= FFTParallelThreshold)
+#endif
+    for(size_t i = 0; i < N; i++) {
+        size_t r = libff::bitreverse(i, logN);
+        vals[r] = i < p.size() ? p[i] : FieldT::zero();
+    }
+
+    internal::fft_bitreversed(vals.data(), N, 1, 1, N);
+}
+
+/**
+ * Sets vals to p(\omega^i) for i = 0, ..., numOut-1 only, where \omega is the primitive Nth root
+ * of unity: e.g., the first n of N = 2^k shares of a degree t-1 polynomial. The work scales with
+ * p.size() and numOut, rather than with N:
+ *
+ *  - If p has L <= M = 2^j coefficients, then, after the bit-reversal, every block of D = N/M
+ *    elements has a single non-zero one, p_{j'}, at its start. The first log D stages only spread
+ *    it across its block, since all their butterflies are (u, 0) -> (u, u). So we fill the blocks
+ *    directly and only do the last log M stages.
+ *  - The widest of these stages are pruned to only compute the first numOut outputs (see
+ *    internal::fft_bitreversed).
+ */
+template<class FieldT>
+void fft_truncated(const std::vector<FieldT>& p, size_t N, size_t numOut, std::vector<FieldT>& vals) {
+    if(!Utils::isPowerOfTwo(N))
+        throw std::runtime_error("FFT size must be a power of two");
+    if(N < p.size())
+        throw std::runtime_error("N has to be greater than polynomial degree");
+    if(N < numOut)
+        throw std::runtime_error("Cannot evaluate at more than N Nth roots of unity");
+    if(&p == &vals)
+        throw std::runtime_error("The truncated FFT cannot be done in place");
+
+    const size_t L = p.size();
+    const size_t M = Utils::smallestPowerOfTwoAbove(std::max<size_t>(L, 1)), logM = Utils::log2floor(M);
+    const size_t D = N / M;
+
+    // for j < M, the bit-reversal of j on log N bits is D times its bit-reversal on log M bits
+    vals.resize(N);
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for if(N >= FFTParallelThreshold)
+#endif
+    for(size_t j = 0; j < M; j++) {
+        const FieldT& coeff = j < L ? p[j] : FieldT::zero();
+        size_t start = D * libff::bitreverse(j, logM);
+        std::fill(vals.begin() + static_cast<long>(start), vals.begin() + static_cast<long>(start + D), coeff);
+    }
+
+    internal::fft_bitreversed(vals.data(), N, 1, D, numOut);
+    vals.resize(numOut);
+}
+
+/**
+ * Sets vals[b][i] = polys[b](\omega^i) for every polynomial b and i = 0, ..., numOut-1, where
+ * \omega is the primitive Nth root of unity: e.g., the first n shares of k dealers' polynomials.
+ *
+ * The k FFTs are done together on an interleaved copy of the polynomials (see
+ * internal::fft_radix2_pass), so every twiddle is loaded once for all k of them, the innermost
+ * loops are over independent polynomials, and even small FFTs have enough work to split across
+ * threads. Like fft_truncated, the work scales with the longest polynomial and numOut.
+ */
+template<class FieldT>
+void fft_batch(const std::vector<std::vector<FieldT>>& polys, size_t N, size_t numOut, std::vector<std::vector<FieldT>>& vals) {
+    if(!Utils::isPowerOfTwo(N))
+        throw std::runtime_error("FFT size must be a power of two");
+    if(N < numOut)
+        throw std::runtime_error("Cannot evaluate at more than N Nth roots of unity");
+    if(&polys == &vals)
+        throw std::runtime_error("The batched FFT cannot be done in place");
+
+    const size_t k = polys.size();
+    size_t L = 0;
+    for(auto& p : polys) {
+        L = std::max(L, p.size());
+    }
+    if(N < L)
+        throw std::runtime_error("N has to be greater than polynomial degree");
+
+    const size_t M = Utils::smallestPowerOfTwoAbove(std::max<size_t>(L, 1)), logM = Utils::log2floor(M);
+    const size_t D = N / M;
+
+    // row D * bitreverse(j) holds the jth coefficients of all polynomials, repeated D times (see fft_truncated)
+    std::vector<FieldT> x(N * k);
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for if(N * k >= FFTParallelThreshold)
+#endif
+    for(size_t j = 0; j < M; j++) {
+        FieldT * row = x.data() + D * libff::bitreverse(j, logM) * k;
+        for(size_t b = 0; b < k; b++) {
+            row[b] = j < polys[b].size() ? polys[b][j] : FieldT::zero();
+        }
+        for(size_t r = 1; r < D; r++) {
+            std::copy(row, row + k, row + r * k);
+        }
+    }
+
+    internal::fft_bitreversed(x.data(), N, k, D, numOut);
+
+    vals.resize(k);
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for if(numOut * k >= FFTParallelThreshold)
+#endif
+    for(size_t b = 0; b < k; b++) {
+        vals[b].resize(numOut);
+        for(size_t i = 0; i < numOut; i++) {
+            vals[b][i] = x[i * k + b];
+        }
+    }
+}
+
+/**
+ * Sets vals[b] to the FFT of size N of polys[b], for every b.
+ */
+template<class FieldT>
+void fft_batch(const std::vector<std::vector<FieldT>>& polys, size_t N, std::vector<std::vector<FieldT>>& vals) {
+    fft_batch(polys, N, N, vals);
+}
+
+/**
+ * Replaces vals (of size N = 2^k) by its inverse FFT: i.e., by the coefficients of the polynomial
+ * p of degree < N with p(\omega^i) = vals[i] for i = 0, ..., N-1.
+ */
+template<class FieldT>
+void ifft_inplace(std::vector<FieldT>& vals) {
+    fft_inplace(vals);
+    internal::ifft_from_fft(vals);
+}
+
+/**
+ * Sets p to the polynomial of degree < N = vals.size() with p(\omega^i) = vals[i] for all i.
+ */
+template<class FieldT>
+void ifft(const std::vector<FieldT>& vals, std::vector<FieldT>& p) {
+    fft(vals, vals.size(), p);
+    internal::ifft_from_fft(p);
+}
+
+/**
+ * Sets vals[i] = p(g \omega^i) for i = 0, ..., N-1: i.e., evaluates p over the coset g H of the
+ * subgroup H of Nth roots of unity, as the FFT of p(g x).
+ */
+template<class FieldT>
+void coset_fft(const std::vector<FieldT>& p, size_t N, const FieldT& g, std::vector<FieldT>& vals) {
+    std::vector<FieldT> pg(p);
+    internal::scale_by_powers(pg, g);
+    fft(pg, N, vals);
+}
+
+/**
+ * Sets p to the polynomial of degree < N = vals.size() with p(g \omega^i) = vals[i] for all i.
+ * This is the inverse of coset_fft().
+ */
+template<class FieldT>
+void coset_ifft(const std::vector<FieldT>& vals, const FieldT& g, std::vector<FieldT>& p) {
+    ifft(vals, p);
+    internal::scale_by_powers(p, g.inverse());
+}
+
+} // end of namespace libpolycrypto
@@ -56,6 +56,19 @@ public:
         //}
         //std::cout << endl;
     }
+
+    /**
+     * Returns e_j = \sum_i r_i (w_N^i)^j for j = 0, ..., t-1, so that \prod_j c_j^{e_j} = \prod_i g^{r_i f(w_N^i)},
+     * where c_j = g^{f_j} is a Feldman commitment to f(x) of degree t-1.
+     *
+     * This lets us check all f(w_N^i) shares at once with one multiexp of size t, rather than with n of them.
+     * The e_j's are the first t outputs of an FFT of the r_i's, which only takes O(N log N) field operations.
+     */
+    void getBatchExps(const std::vector<Fr>& r, std::vector<Fr>& exps) const {
+        assertLessThanOrEqual(r.size(), params.N);
+
+        libpolycrypto::fft_truncated(r, params.N, params.t, exps);
+    }
 };
 
 class FeldmanPlayer : public AbstractPlayer {
@@ -88,10 +101,11 @@ public:
      * for each player j.
      */
     virtual void evaluate() {
-        libpolycrypto::poly_fft(f_id, params.N, shares);
-        shares.resize(params.n);
+        libpolycrypto::fft_truncated(f_id, params.N, params.n, shares);
     }
 
+    virtual bool evaluatesWithFFT() const { return true; }
+
     /**
      * Feldman commits to the polynomial f_id(x).
      */
@@ -100,13 +114,7 @@ public:
 
         // commit to polynomial using Feldman commitments
         // i.e., given c_i's, return g^{c_i}'s
-        comm.resize(f_id.size());
-#ifdef USE_MULTITHREADING
-#pragma omp parallel for
-#endif
-        for(size_t i = 0; i < f_id.size(); i++) {
-            comm[i] = f_id[i] * G1::one();
-        }
+        comm = libpolycrypto::g1ExpBatch(f_id);
     }
     
     /**
@@ -121,6 +129,14 @@ public:
      */
     bool verifySharesIndividually(const std::vector<AbstractPlayer*>& allPlayers) {
         std::vector<Fr> exps;
+        fpp.getPlayerExps(id, exps);
+
+        // with more than one dealer, first check all shares at once, which is much faster when they are all good
+        if(allPlayers.size() > 1 && verifySharesBatched(allPlayers, exps)) {
+            return true;
+        }
+
+        // otherwise, check them one by one to find the bad one
         for(size_t i = 0; i < allPlayers.size(); i++) {
             const FeldmanPlayer& p = *dynamic_cast<FeldmanPlayer*>(allPlayers[i]);
 
@@ -132,8 +148,7 @@ public:
             // verify your share of f_i(x) against player i's commitment of f_i(x)
             assertNotEqual(p.shares[id], Fr::zero());
 
-            G1 shareVk = p.shares[id] * G1::one();
-            fpp.getPlayerExps(id, exps);
+            G1 shareVk = g1Exp(p.shares[id]);
             G1 result = multiExp<G1>(p.comm, exps);
 
             if(shareVk != result) {
@@ -145,14 +160,59 @@ public:
         return true;
     }
 
+    /**
+     * Checks g^{\sum_i r_i f_i(j)} = \prod_i \prod_k c_{i,k}^{r_i (w_N^j)^k} for random r_i's, which holds (w.h.p.)
+     * only if all f_i(j) shares verify against their f_i(x) commitments. This is a single multiexp of size
+     * n*t, which is cheaper than n multiexps of size t. The exps are the (w_N^j)^k's from getPlayerExps().
+     */
+    bool verifySharesBatched(const std::vector<AbstractPlayer*>& allPlayers, const std::vector<Fr>& exps) const {
+        std::vector<G1> bases;
+        std::vector<Fr> randExps;
+        bases.reserve(allPlayers.size() * params.t);
+        randExps.reserve(allPlayers.size() * params.t);
+
+        Fr combinedShare = Fr::zero();
+        for(size_t i = 0; i < allPlayers.size(); i++) {
+            const FeldmanPlayer& p = *dynamic_cast<FeldmanPlayer*>(allPlayers[i]);
+
+            if(isDkgPlayer && p.id == id) {
+                continue;
+            }
+
+            assertNotEqual(p.shares[id], Fr::zero());
+            assertEqual(p.comm.size(), exps.size());
+
+            Fr r = Fr::random_element();
+            combinedShare = combinedShare + r * p.shares[id];
+            for(size_t k = 0; k < exps.size(); k++) {
+                bases.push_back(p.comm[k]);
+                randExps.push_back(r * exps[k]);
+            }
+        }
+
+        return g1Exp(combinedShare) == multiExp<G1>(bases, randExps);
+    }
+
     /**
      * Verifies each player i's share against the final polynomial f(x). 
      */
     bool verifySharesWorstCaseReconstruction() {
-        std::vector<Fr> exps;
+        // first, check all n shares at once against a random linear combination of them
+        std::vector<Fr> r = libpolycrypto::random_field_elems(params.n), exps;
+        Fr combinedShare = Fr::zero();
+        for(size_t pid = 0; pid < params.n; pid++) {
+            combinedShare = combinedShare + r[pid] * shares[pid];
+        }
+
+        fpp.getBatchExps(r, exps);
+        if(g1Exp(combinedShare) == multiExp<G1>(comm, exps)) {
+            return true;
+        }
+
+        // some share is bad, so check them one by one to find it
         for(size_t pid = 0; pid < params.n; pid++) {
             // verify player i's share against the final commitment of f(x)
-            G1 shareVk = shares[pid] * G1::one();
+            G1 shareVk = g1Exp(shares[pid]);
             fpp.getPlayerExps(pid, exps);
             G1 result = multiExp<G1>(comm, exps);
 
@@ -226,7 +286,7 @@ public:
         assertNotEqual(share, Fr::zero());
 
         std::vector<Fr> exps;
-        G1 shareVk = share * G1::one();
+        G1 shareVk = g1Exp(share);
         fpp.getPlayerExps(id, exps);
         G1 result = multiExp<G1>(commFinal, exps);
 
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <polycrypto/PolyCrypto.h>
+#include <polycrypto/Pippenger.h>
+
+namespace libpolycrypto {
+
+/**
+ * Precomputed table for multiexps over fixed bases (e.g., a prefix of the q-SDH parameters),
+ * in the style of Brickell-Gordon-McCurley-Wilson: for every base P_i and every c-bit window j,
+ * it stores P_i^{2^{cj}} in affine form. A multiexp then no longer needs the c doublings per
+ * window of Pippenger, nor a separate set of buckets for every window: every (i, j) pair just
+ * adds P_i^{2^{cj}} to the bucket of the jth digit of the ith exponent, with a mixed addition.
+ *
+ * When a multiexp uses only a few of the bases, 2^c buckets would be too many, so the c-bit
+ * digits are further cut into smaller slices, each with its own buckets, which are then
+ * combined with doublings (see multiExp()).
+ *
+ * The table takes numBases * ceil(|Fr| / c) points, so a larger window means less memory.
+ */
+template<class Group>
+class FixedBaseTable {
+protected:
+    size_t numBases;
+    size_t c;           // window size in bits
+    size_t numWindows;  // ceil(|Fr| / c)
+    std::vector<Group> table;   // table[i * numWindows + j] = P_i^{2^{cj}}
+
+public:
+    /**
+     * Precomputes the table for the bases in [begin, end). If window is 0, picks the window
+     * that minimizes the cost of a multiexp over all the bases, among the ones whose table fits
+     * in memoryBudget bytes (if not 0). Throws std::runtime_error if no window fits.
+     */
+    FixedBaseTable(
+        typename std::vector<Group>::const_iterator begin,
+        typename std::vector<Group>::const_iterator end,
+        size_t window = 0,
+        size_t memoryBudget = 0)
+        : numBases(static_cast<size_t>(end - begin)), c(window), numWindows(0)
+    {
+        if(c == 0) {
+            c = pickWindowSize(numBases, memoryBudget);
+        } else if(memoryBudget > 0 && getMemoryUsage(numBases, c) > memoryBudget) {
+            throw std::runtime_error("Fixed-base table with the requested window does not fit in the memory budget");
+        }
+
+        if(c == 0 || c > MaxWindow) {
+            throw std::runtime_error("Fixed-base table window must be between 1 and " + std::to_string(MaxWindow) + " bits");
+        }
+
+        numWindows = (Fr::size_in_bits() + c - 1) / c;
+        table.resize(numBases * numWindows);
+
+        // every thread normalizes its own range of bases, with one inversion
+#ifdef USE_MULTITHREADING
+        size_t numRanges = std::min(getNumCores(), std::max<size_t>(numBases, 1));
+#else
+        size_t numRanges = 1;
+#endif
+        size_t rangeSize = (numBases + numRanges - 1) / numRanges;
+
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for
+#endif
+        for(size_t r = 0; r < numRanges; r++) {
+            size_t rbegin = r * rangeSize, rend = std::min(rbegin + rangeSize, numBases);
+            if(rbegin >= rend)
+                continue;
+
+            std::vector<Group> local((rend - rbegin) * numWindows);
+            for(size_t i = rbegin; i < rend; i++) {
+                Group p = *(begin + static_cast<long>(i));
+                for(size_t j = 0; j < numWindows; j++) {
+                    local[(i - rbegin) * numWindows + j] = p;
+                    for(size_t b = 0; b < c; b++) {
+                        p = p.dbl();
+                    }
+                }
+            }
+
+            libff::batch_to_special(local);
+            std::copy(local.begin(), local.end(), table.begin() + static_cast<long>(rbegin * numWindows));
+        }
+    }
+
+public:
+    // beyond this, the buckets for a multiexp over all the bases take more memory than the table
+    static const size_t MaxWindow = 24;
+
+    /**
+     * Returns how many bytes a table for numBases with the given window takes.
+     */
+    static size_t getMemoryUsage(size_t numBases, size_t window) {
+        return numBases * ((Fr::size_in_bits() + window - 1) / window) * sizeof(Group);
+    }
+
+    size_t getMemoryUsage() const { return table.size() * sizeof(Group); }
+    size_t getNumBases() const { return numBases; }
+    size_t getWindowSize() const { return c; }
+
+protected:
+    /**
+     * A multiexp over n bases costs about n * ceil(|Fr| / c) additions, plus 2 * 2^c to sum the buckets.
+     */
+    static size_t pickWindowSize(size_t n, size_t memoryBudget) {
+        size_t best = 0, bestCost = 0;
+        for(size_t w = 1; w <= MaxWindow; w++) {
+            if(memoryBudget > 0 && getMemoryUsage(n, w) > memoryBudget)
+                continue;
+
+            size_t cost = n * ((Fr::size_in_bits() + w - 1) / w) + (static_cast<size_t>(1) << (w + 1));
+            if(best == 0 || cost < bestCost) {
+                best = w;
+                bestCost = cost;
+            }
+        }
+
+        if(best == 0) {
+            throw std::runtime_error("Fixed-base table does not fit in the memory budget for any window size");
+        }
+        return best;
+    }
+
+public:
+    /**
+     * Computes \prod_i P_i^{e_i} for the exponents in [exp_begin, exp_end), which can be fewer
+     * than the bases (i.e., only the first few bases are used).
+     */
+    Group multiExp(
+        typename std::vector<Fr>::const_iterator exp_begin,
+        typename std::vector<Fr>::const_iterator exp_end,
+        size_t numThreads) const
+    {
+        size_t m = static_cast<size_t>(exp_end - exp_begin);
+        if(m > numBases) {
+            throw std::runtime_error("Fixed-base table has fewer bases than the number of exponents");
+        }
+        if(m == 0)
+            return Group::zero();
+
+        numThreads = std::max<size_t>(numThreads, 1);
+
+        typedef decltype(exp_begin->as_bigint()) BigInt;
+        std::vector<BigInt> scalars(m);
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for
+#endif
+        for(size_t i = 0; i < m; i++) {
+            scalars[i] = (exp_begin + static_cast<long>(i))->as_bigint();
+        }
+
+        // cut the c-bit digits into slices of s bits, with 2^s buckets each, where s minimizes
+        // the cost of m * numWindows additions per slice and 2 * 2^s additions per slice's buckets
+        size_t s = c, bestCost = 0;
+        for(size_t w = 1; w <= c; w++) {
+            size_t numSlices = (c + w - 1) / w;
+            size_t cost = numSlices * (m * numWindows + (static_cast<size_t>(1) << (w + 1)));
+            if(w == 1 || cost < bestCost) {
+                s = w;
+                bestCost = cost;
+            }
+        }
+        const size_t numSlices = (c + s - 1) / s;
+        const size_t numBuckets = (static_cast<size_t>(1) << s) - 1;
+
+        // split the bases into ranges, so that every thread has a task, but without making the
+        // ranges so small that summing up the buckets dominates
+        size_t numRanges = (numThreads + numSlices - 1) / numSlices;
+        numRanges = std::max<size_t>(std::min(numRanges, (m * numWindows) / (2 * (numBuckets + 1))), 1);
+        const size_t rangeSize = (m + numRanges - 1) / numRanges;
+        const size_t numTasks = numSlices * numRanges;
+
+        std::vector<Group> taskSums(numTasks, Group::zero());
+
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for(size_t t = 0; t < numTasks; t++) {
+            size_t k = t / numRanges, r = t % numRanges;
+            size_t begin = r * rangeSize, end = std::min(begin + rangeSize, m);
+            size_t width = std::min(s, c - k * s);
+
+            std::vector<Group> buckets(numBuckets, Group::zero());
+            for(size_t i = begin; i < end; i++) {
+                const Group * row = table.data() + i * numWindows;
+                for(size_t j = 0; j < numWindows; j++) {
+                    size_t d = pippengerDigit(scalars[i], j * c + k * s, width);
+                    if(d == 0)
+                        continue;
+
+                    Group& bucket = buckets[d - 1];
+                    bucket = bucket.mixed_add(row[j]);
+                }
+            }
+
+            Group running = Group::zero(), sum = Group::zero();
+            for(size_t d = numBuckets; d > 0; d--) {
+                running = running + buckets[d - 1];
+                sum = sum + running;
+            }
+
+            taskSums[t] = sum;
+        }
+
+        // combine the slices, from the most significant one down
+        Group result = Group::zero();
+        for(size_t k = numSlices; k > 0; k--) {
+            for(size_t b = 0; b < s; b++) {
+                result = result.dbl();
+            }
+            for(size_t r = 0; r < numRanges; r++) {
+                result = result + taskSums[(k - 1) * numRanges + r];
+            }
+        }
+
+        return result;
+    }
+};
+
+/**
+ * Performs a multi-exponentiation over the first exps.size() bases of the table.
+ */
+template<class Group>
+Group multiExp(
+    const FixedBaseTable<Group>& table,
+    const std::vector<Fr>& exps)
+{
+    return table.multiExp(exps.cbegin(), exps.cend(), getNumCores());
+}
+
+/**
+ * Like multiExpBatch() in PolyCrypto.h, but over the bases of the table.
+ */
+template<class Group, class Poly>
+std::vector<Group> multiExpBatch(
+    const FixedBaseTable<Group>& table,
+    const std::vector<const Poly*>& exps,
+    size_t grainSize = MultiExpGrainSize)
+{
+    std::vector<size_t> sizes(exps.size());
+    for(size_t j = 0; j < exps.size(); j++) {
+        sizes[j] = exps[j]->size();
+    }
+
+    std::vector<Group> results(exps.size(), Group::zero());
+    scheduleMultiExps(sizes, [&](size_t j) {
+        results[j] = table.multiExp(exps[j]->cbegin(), exps[j]->cend(), getNumCores());
+    }, grainSize);
+
+    return results;
+}
+
+} // end of namespace libpolycrypto
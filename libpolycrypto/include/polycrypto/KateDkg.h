@@ -18,6 +18,9 @@ using libpolycrypto::G1;
 using libpolycrypto::G2;
 using libpolycrypto::GT;
 using libpolycrypto::ReducedPairing;
+using libpolycrypto::MultiPairing;
+using libpolycrypto::PreparedG2;
+using libpolycrypto::preparedG2One;
 using libpolycrypto::multiExp;
 
 /**
@@ -35,9 +38,12 @@ public:
     G1 zeroProof;                   // proof for p(0), i.e., the secret
     G2 g2toId;                      // g2^(s - w_N^id); needed for verifying this player's shares on other player's polynomials
 
+    // g2^(s - w_N^id) and g2^s, prepared for pairing, since we pair with them once per dealer
+    PreparedG2 g2toIdPrepared, g2toSPrepared;
+
 public:
     AllConstantSizedProofs(const KatePublicParameters& kpp, size_t n)
-        : kpp(kpp)
+        : kpp(kpp), g2toSPrepared(kpp.getG2toS())
     {
         playerProof.resize(n);
     }
@@ -73,28 +79,29 @@ public:
     void addVerificationHelpers(const G2& g2toId) {
         //loginfo << "VK: " << g2toId << endl;
         this->g2toId = g2toId;
+        g2toIdPrepared = PreparedG2(g2toId);
     }
 
     /**
      * Verifies that p_j(w_N^id) = val, where p_j is committed in polyComm.
      */
     bool verifyAtId(const G1& polyComm, const G1& proof, const Fr& val) const {
-        return verifyKateProof(polyComm, proof, val * G1::one(), g2toId);
+        return verifyKateProof(polyComm, proof, g1Exp(val), g2toIdPrepared);
     }
 
     /**
      * Verifies that valComm = g^p_j(0), where p_j is committed in polyComm.
      */
     bool verifyAtZero(const G1& polyComm, const G1& proof, const G1& valComm) const {
-        return verifyKateProof(polyComm, proof, valComm, kpp.getG2toS()); 
+        return verifyKateProof(polyComm, proof, valComm, g2toSPrepared);
     }
 
     /**
      * Verifies that valComm = g^p_j(z), where p_j is committed in polyComm and z is committed in acc = g^{s - z}.
      */
-    bool verifyKateProof(const G1& polyComm, const G1& proof, const G1& valComm, const G2& acc) const {
-        return ReducedPairing(polyComm - valComm, G2::one()) ==
-               ReducedPairing(proof, acc);
+    bool verifyKateProof(const G1& polyComm, const G1& proof, const G1& valComm, const PreparedG2& acc) const {
+        // e(g^{p(s)} / g^{p(z)}, g) = e(\pi, g^{s - z}) iff e(g^{p(z)} / g^{p(s)}, g) e(\pi, g^{s - z}) = 1
+        return MultiPairing({ valComm - polyComm, proof }, std::vector<const PreparedG2*>{ &preparedG2One(), &acc }) == GT::one();
     }
 };
 
@@ -113,7 +120,7 @@ public:
 
         assertEqual(
             params.getMonomialCommitment(id),
-            kpp.getG2toS() - params.omegas[id] * G2::one());
+            kpp.getG2toS() - g2Exp(params.omegas[id]));
         allProofs->addVerificationHelpers(params.getMonomialCommitment(id));
 
         proofFinal = G1::zero();
@@ -128,18 +135,36 @@ public:
          */
     }
     virtual void computeRealProofs() {
-        // TODO: all proofs can be multithreaded, but there's no point for now, unless we can multithread the verification too, which we cannot due to libff parallel pairing bug
-        // compute proof for f(0)
-        allProofs->setZeroProof(std::get<0>(kateProve(Fr::zero())));
+        // We compute the quotients for f(0) and for all f_id(w_N^j) one batch at a time, so as to
+        // commit to a whole batch in parallel without keeping all n quotients in memory.
+        size_t numPoints = params.n + 1;    // point 0 is for f(0), point i + 1 is for player i
+        size_t batchSize = 4 * libpolycrypto::getNumCores();
+        std::vector<std::vector<Fr>> quos(batchSize);
+        std::vector<const std::vector<Fr>*> quoPtrs;
 
-        // compute f_id(w_N^j) and its proof for all players j
         shares.resize(params.n);
-        for(size_t i = 0; i < params.n; i++) {
-            // NOTE: Although this player doesn't verify his own f_id(id) proof, we still need 
-            // to compute this proof so we can aggregate it into a proof for the final f(id).
-            G1 pi;
-            std::tie(pi, shares[i]) = kateProve(params.omegas[i]);
-            allProofs->setPlayerProof(i, pi);
+        for(size_t start = 0; start < numPoints; start += batchSize) {
+            size_t end = std::min(start + batchSize, numPoints);
+
+            quoPtrs.clear();
+            for(size_t p = start; p < end; p++) {
+                // NOTE: Although this player doesn't verify his own f_id(id) proof, we still need 
+                // to compute this proof so we can aggregate it into a proof for the final f(id).
+                Fr eval;
+                kateEval(p == 0 ? Fr::zero() : params.omegas[p - 1], quos[p - start], eval);
+                if(p > 0)
+                    shares[p - 1] = eval;
+
+                quoPtrs.push_back(&quos[p - start]);
+            }
+
+            std::vector<G1> proofs = kpp.commitBatch(quoPtrs);
+            for(size_t p = start; p < end; p++) {
+                if(p == 0)
+                    allProofs->setZeroProof(proofs[p - start]);
+                else
+                    allProofs->setPlayerProof(p - 1, proofs[p - start]);
+            }
         }
     }
 
@@ -149,20 +174,19 @@ public:
         
         // compute p(s)
         Fr pOfS = libfqfft::evaluate_polynomial(f_id.size(), f_id, s);
-        assertEqual(comm, pOfS * G1::one());
+        assertEqual(comm, g1Exp(pOfS));
 
         // simulate p(0) proof
         allProofs->setZeroProof(
-            ( (pOfS - f_id[0])*s.inverse() ) * G1::one());
+            g1Exp( (pOfS - f_id[0])*s.inverse() ));
 
         // evaluate at all points, so we can simulate proofs
-        libpolycrypto::poly_fft(f_id, params.N, shares);
-        shares.resize(params.n);
+        libpolycrypto::fft_truncated(f_id, params.N, params.n, shares);
 
         // simulate proof for player i as g^{(p(s) - p(i))/(s - w_N^i)}
         for(size_t i = 0; i < params.n; i++) {
             allProofs->setPlayerProof(i, 
-                ( (pOfS - shares[i])*(s - params.omegas[i]).inverse() ) * G1::one());
+                g1Exp( (pOfS - shares[i])*(s - params.omegas[i]).inverse() ));
         }
     }
 
@@ -206,7 +230,7 @@ public:
                 logerror << "KZG proof of player " << pid << " did not verify during reconstruction" << endl;
                 loginfo << " - proof: " << pi << endl;
                 loginfo << " - VK:    " << vk << endl;
-                auto actualVk = kpp.getG2toS() - params.omegas[pid] * G2::one();
+                auto actualVk = kpp.getG2toS() - g2Exp(params.omegas[pid]);
                 loginfo << " - g2^{s - w_N^" << pid << "}: " << actualVk << endl;
                 testAssertEqual(vk, actualVk);
                 return false;
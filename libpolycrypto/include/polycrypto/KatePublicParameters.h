@@ -1,8 +1,10 @@
 #pragma once
 
+#include <map>
 #include <memory>
 
 #include <polycrypto/PolyCrypto.h>
+#include <polycrypto/FixedBaseMultiExp.h>
 #include <polycrypto/NtlLib.h>
 
 #include <xutils/Log.h>
@@ -16,57 +18,123 @@ using libpolycrypto::G2;
 using libpolycrypto::ReducedPairing;
 using libpolycrypto::multiExp;
 using libpolycrypto::convNtlToLibff;
+using libpolycrypto::FixedBaseTable;
 
 class KatePublicParameters {
 public:
     size_t q;
     std::vector<G1> g1si;   // g1si[i] = g1^{s^i}
-    std::vector<G2> g2si;   // g2si[i] = g2^{s^i}
+    std::vector<G2> g2si;   // g2si[i] = g2^{s^i}, unless only some of them were loaded (see fromBinaryWithG2Subset())
     Fr s;
 
 protected:
+    // g2^{s^i} for the i's passed to fromBinaryWithG2Subset() (in which case g2si is empty)
+    std::map<size_t, G2> g2Subset;
+
+    // optional fixed-base table for g1si[0, ...), see precomputeG1Table()
+    std::shared_ptr<const FixedBaseTable<G1>> g1Table;
+
+protected:
+    KatePublicParameters()
+        : q(0)
+    {}
+
+    /**
+     * Generates q-SDH params for a random trapdoor s. Used for testing.
+     */
     KatePublicParameters(size_t q)
-        : q(q)
-    {
-        resize(q);
-
-        // pick trapdoor s
-        s = Fr::random_element();
-
-        Fr si = s^0;
-        int prevPct = -1;
-        size_t c = 0;
-
-        loginfo << "Generating q-SDH params, q = " << q << endl;
-        for (size_t i = 0; i <= q; i++) {
-            g1si[i] = si * G1::one();
-            g2si[i] = si * G2::one();
-        
-            si *= s;
-
-            c++;
-
-            int pct = static_cast<int>(static_cast<double>(c)/static_cast<double>(q + 1) * 100.0);
-            if(pct > prevPct) {
-                logdbg << pct << "% ... (i = " << i << " out of " << q << ")" << endl;
-                prevPct = pct;
-            }
-        }
-    }
+        : KatePublicParameters(Fr::random_element(), q)
+    {}
+
+    /**
+     * Computes g1^{s^i} and g2^{s^i} for all i \in [0, q] in memory (see generate()).
+     */
+    KatePublicParameters(const Fr& s, size_t q);
+
+    /**
+     * Implements fromBinary() and, when g2Indices is not null, fromBinaryWithG2Subset().
+     */
+    static KatePublicParameters readBinary(const std::string& binFile, const std::string& trapFile,
+        size_t maxQ, bool verifyChecksum, const std::vector<size_t>* g2Indices);
+
+    /**
+     * Reads 'count' parameters from inFile into g1si[start, start + count) and g2si[start, start + count).
+     */
+    void readChunk(const std::string& inFile, size_t start, size_t count, bool progress, bool verify);
 
 public:
     /**
      * Reads s, tau and q from trapFile.
      * Then reads the q-PKE parameters from trapFile + "-0", trapFile + "-1", ...
      * and so on, until q+1 parameters are read: g, g^s, \dots, g^{s^q}.
+     * Each file is read on its own thread (when built with USE_MULTITHREADING).
      */
     KatePublicParameters(const std::string& trapFile, size_t maxQ = 0, bool progress = true, bool verify = false);
 
+    /**
+     * Reads the parameters from a binary file written by writeBinary(). The file is mmap'd
+     * and its fixed-size records are copied directly into g1si and g2si, with no parsing.
+     * If trapFile is not empty, the trapdoor s is read from it (see generateTrapdoor()).
+     * If maxQ is not 0, only g^{s^i} for i \in [0, maxQ] are read.
+     *
+     * File layout: a 64-byte header (magic, format version, flags, q, the sizes of the G1 and G2
+     * records and a checksum for each), then q+1 G1 records, then q+1 G2 records.
+     *
+     * NOTE: Uncompressed records are the raw in-memory affine libff points, so such a file can
+     * only be read by a build with the same curve and point layout (the header's record sizes are
+     * checked). Compressed records (see PointCompression.h) are portable and take a third of the
+     * space, but every point costs a square root to decompress.
+     * The text chunks remain the canonical format; see app/ParamsConvertToBinary.cpp.
+     */
+    static KatePublicParameters fromBinary(const std::string& binFile, const std::string& trapFile = "",
+        size_t maxQ = 0, bool verifyChecksum = true);
+
+    /**
+     * Like fromBinary(), but only reads g2^{s^i} for the i's in g2Indices (e.g., getAmtG2Indices()),
+     * by seeking straight to their records, and leaves g2si empty. Use getG2si() to get them.
+     * This keeps the G2 memory at O(log q) for AMT-only deployments, which never need the rest.
+     *
+     * If verifyChecksum is true, the G1 records are checksummed and every G2 point read is checked
+     * against its G1 counterpart with a pairing, since checksumming all G2 records would mean
+     * reading all of them.
+     */
+    static KatePublicParameters fromBinaryWithG2Subset(const std::string& binFile, const std::vector<size_t>& g2Indices,
+        const std::string& trapFile = "", size_t maxQ = 0, bool verifyChecksum = true);
+
+    /**
+     * Returns the indices i of the g2^{s^i}'s that AMT needs: 0, 1 and all powers of two up to q.
+     * (AMT accumulators are monomials x^n - c with n a power of two, and Kate verification needs g2^s.)
+     */
+    static std::vector<size_t> getAmtG2Indices(size_t q);
+
 public:
     static Fr generateTrapdoor(size_t q, const std::string& outFile);
 
+    /**
+     * Reads the trapdoor s and the number of parameters q from the trapdoor file.
+     */
+    static void readTrapdoor(const std::string& trapFile, Fr& s, size_t& q);
+
+    /**
+     * Writes g1^{s^i} and g2^{s^i} for i \in [startIncl, endExcl) to outFile, in the text format
+     * read by the constructor. The powers are computed using fixed-base window tables for the
+     * two generators, split across threads and normalized to affine before being written.
+     */
     static void generate(size_t startIncl, size_t endExcl, const Fr& s, const std::string& outFile, bool progress);
 
+    /**
+     * Like generate(), but writes all q+1 parameters to numChunks files, trapFile + "-0",
+     * trapFile + "-1", and so on, reusing the same window tables for all of them.
+     */
+    static void generateChunks(const Fr& s, size_t q, const std::string& trapFile, size_t numChunks, bool progress);
+
+    /**
+     * Generates the parameters for trapdoor s in memory, e.g., to write them with writeBinary().
+     */
+    static KatePublicParameters fromTrapdoor(const Fr& s, size_t q) {
+        return KatePublicParameters(s, q);
+    }
+
     /**
      * Generates Kate public parameters on the fly. Used for testing.
      */
@@ -75,6 +143,88 @@ public:
     }
     
 
+public:
+    /**
+     * Writes g1si and g2si to binFile in the binary format read by fromBinary(),
+     * optionally compressing every point.
+     */
+    void writeBinary(const std::string& binFile, bool compressed = false) const;
+
+    /**
+     * Checks, without the trapdoor, that g1si and g2si are the powers g^{s^i} of the same s,
+     * for the standard generators. Picks random r_i's and checks that:
+     *
+     *   e(\sum_{i<q} r_i g1^{s^{i+1}}, g2) = e(\sum_{i<q} r_i g1^{s^i}, g2^s)
+     *   e(\sum_{i<=q} r'_i g1^{s^i}, g2) = e(g1, \sum_{i<=q} r'_i g2^{s^i})
+     *
+     * The first check catches any g1^{s^{i+1}} that is not the previous power times s (where
+     * s is the one in g2^s) and the second any g2^{s^i} that does not match g1^{s^i}, except
+     * with probability about 1/|Fr|. Costs four multiexps of size q and four pairings, rather
+     * than 2(q+1) exponentiations.
+     *
+     * The pairing is only bilinear on G1 x G2, so it also checks that \sum r'_i g1^{s^i} and
+     * \sum r'_i g2^{s^i} are in the r-torsion, which catches any point outside of its group (e.g.,
+     * a decompressed point on the twist, but not in G2). A point whose component outside the group
+     * has small order l escapes this with probability 1/l, and l >= 10069 on BN-P254's twist.
+     */
+    bool validatePowers() const;
+
+public:
+    /**
+     * Precomputes a fixed-base table (see FixedBaseMultiExp.h) for g1si[0, numBases), or for all
+     * of g1si if numBases is 0, which commit() then uses for polynomials of degree < numBases.
+     * This is a one-time cost (|Fr| / window doublings per base) for a long-running dealer,
+     * in exchange for faster commitments and proofs.
+     */
+    void precomputeG1Table(size_t numBases = 0, size_t window = 0, size_t memoryBudget = 0) {
+        numBases = numBases == 0 ? g1si.size() : numBases;
+        assertLessThanOrEqual(numBases, g1si.size());
+
+        g1Table = std::make_shared<const FixedBaseTable<G1>>(
+            g1si.cbegin(), g1si.cbegin() + static_cast<long>(numBases), window, memoryBudget);
+    }
+
+    bool hasG1Table() const {
+        return g1Table != nullptr;
+    }
+
+    /**
+     * Returns the Kate commitment g1^{p(s)} to the polynomial p with coefficients [begin, end),
+     * using the fixed-base table when there is one for enough bases.
+     */
+    G1 commit(std::vector<Fr>::const_iterator begin, std::vector<Fr>::const_iterator end) const {
+        size_t n = static_cast<size_t>(end - begin);
+        assertLessThanOrEqual(n, g1si.size());
+
+        if(g1Table != nullptr && n <= g1Table->getNumBases()) {
+            return g1Table->multiExp(begin, end, libpolycrypto::getNumCores());
+        }
+
+        return multiExp<G1>(g1si.cbegin(), g1si.cbegin() + static_cast<long>(n), begin, end);
+    }
+
+    G1 commit(const std::vector<Fr>& coeffs) const {
+        return commit(coeffs.cbegin(), coeffs.cend());
+    }
+
+    /**
+     * Commits to many polynomials at once, spreading them across threads (see multiExpBatch()).
+     * Small commitments are grouped into tasks of at least grainSize exponentiations.
+     */
+    template<class Poly>
+    std::vector<G1> commitBatch(const std::vector<const Poly*>& polys, size_t grainSize = libpolycrypto::MultiExpGrainSize) const {
+        size_t maxSize = 0;
+        for(auto p : polys) {
+            maxSize = std::max(maxSize, p->size());
+        }
+
+        if(g1Table != nullptr && maxSize <= g1Table->getNumBases()) {
+            return libpolycrypto::multiExpBatch(*g1Table, polys, grainSize);
+        }
+
+        return libpolycrypto::multiExpBatch<G1>(g1si, polys, grainSize);
+    }
+
 public:
     void resize(size_t q) {
         g1si.resize(q+1); // g1^{s^i} with i from 0 to q, including q
@@ -86,8 +236,28 @@ public:
     }
 
     G2 getG2toS() const {
-        assertStrictlyGreaterThan(g2si.size(), 1);
-        return g2si[1];
+        return getG2si(1);
+    }
+
+    /**
+     * Returns true if g2^{s^i} was loaded.
+     */
+    bool hasG2si(size_t i) const {
+        return i < g2si.size() || g2Subset.count(i) > 0;
+    }
+
+    /**
+     * Returns g2^{s^i}. Throws std::runtime_error if it was not loaded.
+     */
+    const G2& getG2si(size_t i) const {
+        if(i < g2si.size())
+            return g2si[i];
+
+        auto it = g2Subset.find(i);
+        if(it == g2Subset.end()) {
+            throw std::runtime_error("g2^{s^" + std::to_string(i) + "} was not loaded");
+        }
+        return it->second;
     }
  
     const Fr& getTrapdoor() const {
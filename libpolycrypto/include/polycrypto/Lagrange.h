@@ -40,3 +40,19 @@ void lagrange_coefficients(std::vector<Fr>& lagr, const std::vector<Fr>& allOmeg
  * @param T             the actual signer IDs: i.e., i such that allOmegas[i] \in someOmegas
  */
 void lagrange_coefficients_naive(std::vector<Fr>& L, const std::vector<Fr>& allOmegas, const std::vector<Fr>& someOmegas, const std::vector<size_t>& T);
+
+/**
+ * Recovers the polynomial f of degree < k = |T| such that f(w_N^{T[i]}) = evals[i], for all i, in
+ * O(N \log{N} + k \log^2{k}) time, rather than the O(k^2) time of summing up Lagrange polynomials.
+ *
+ * Let Num(x) = \prod_{i\in T} (x - w_N^i) and c_i = evals[i] / Num'(w_N^i). Then:
+ *  f(x) = \sum_{i\in T} c_i Num(x) / (x - w_N^i) = Num(x) g(x) / (x^N - 1),
+ * where g(x) = \sum_{i\in T} c_i (x^N - 1) / (x - w_N^i) has coefficients g_j = \sum_{i\in T} c_i w_N^{-i(j+1)},
+ * which is an FFT. Since f has degree < N, the first k coefficients of Num(x) g(x) are those of -f(x).
+ *
+ * @param[out] f        the coefficients of the interpolated polynomial
+ * @param allOmegas     all N Nth roots of unity w_N^k
+ * @param T             the distinct indices of the evaluation points, in {0, ..., N-1}
+ * @param evals         evals[i] is the evaluation at w_N^{T[i]}
+ */
+void interpolate_at_roots_of_unity(std::vector<Fr>& f, const std::vector<Fr>& allOmegas, const std::vector<size_t>& T, const std::vector<Fr>& evals);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace libpolycrypto {
+
+/**
+ * Read-only memory mapping of a whole file. The mapping lives for as long as
+ * the object does.
+ */
+class MappedFile {
+protected:
+    std::string file;
+    const unsigned char * buf;
+    size_t len;
+
+public:
+    /**
+     * Maps the entire file in memory. Throws std::runtime_error if the file
+     * cannot be opened or mapped.
+     */
+    MappedFile(const std::string& file);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+public:
+    const unsigned char * data() const { return buf; }
+    size_t size() const { return len; }
+    const std::string& getFileName() const { return file; }
+
+    /**
+     * Tells the kernel we are about to read the bytes in [offset, offset + n) in order,
+     * so it can read ahead aggressively.
+     */
+    void adviseSequential(size_t offset, size_t n) const;
+};
+
+} // end of namespace libpolycrypto
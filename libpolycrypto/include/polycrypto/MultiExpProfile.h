@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <polycrypto/PolyCrypto.h>
+
+namespace libpolycrypto {
+
+/**
+ * initialize() loads the multiexp profile from the file named by this environment variable, if set.
+ */
+const char * const MultiExpProfileEnvVar = "POLYCRYPTO_MULTIEXP_PROFILE";
+
+/**
+ * The multiexp thresholds measured for a group with a given number of threads.
+ */
+struct MultiExpProfileEntry {
+    std::string group;      // "G1" or "G2"
+    size_t numThreads;
+    MultiExpThresholds thresholds;
+};
+
+/**
+ * Reads a profile file: one "<group> <num-threads> <bos-coster> <bdlo12> <pippenger>" line per
+ * entry, where a threshold of 0 means the method is never used. Lines starting with # are ignored.
+ * Throws std::runtime_error if the file cannot be read or parsed.
+ */
+std::vector<MultiExpProfileEntry> readMultiExpProfile(const std::string& file);
+
+void writeMultiExpProfile(const std::string& file, const std::vector<MultiExpProfileEntry>& entries);
+
+/**
+ * Sets the G1 and G2 thresholds used by multiExp() to the ones in the profile for getNumCores()
+ * threads. Returns false (and leaves the thresholds alone) if the profile has no such entry.
+ */
+bool loadMultiExpProfile(const std::string& file);
+
+/**
+ * Times every multiexp method on random multiexps of size 2, 4, 8, ..., up to maxSize, with
+ * numThreads threads, and returns the sizes from which each method is the fastest for good.
+ * Each size is timed over enough repetitions to take at least minMillis per method.
+ */
+template<class Group>
+MultiExpThresholds calibrateMultiExp(size_t numThreads, size_t maxSize, size_t minMillis = 50);
+
+} // end of namespace libpolycrypto
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <libff/algebra/curves/public_params.hpp>
+
+namespace libpolycrypto {
+
+/**
+ * Returns the window size (in bits) used by pippengerMultiExp() for n bases: about ln(n) + 2,
+ * which balances the n additions per window against the 2 * 2^c additions for summing the buckets.
+ */
+inline size_t pippengerWindowSize(size_t n) {
+    if(n < 32)
+        return 3;
+
+    size_t log2n = 0;
+    while((n >> (log2n + 1)) != 0)
+        log2n++;
+
+    // ln(n) = log2(n) * ln(2), and ln(2) ~= 0.69
+    return std::min<size_t>(log2n * 69 / 100 + 2, 16);
+}
+
+/**
+ * Returns the c bits of the scalar starting at bit 'start', as an unsigned integer.
+ */
+template<class BigInt>
+size_t pippengerDigit(const BigInt& b, size_t start, size_t c) {
+    const size_t limbBits = sizeof(b.data[0]) * 8;
+    const size_t numLimbs = sizeof(b.data) / sizeof(b.data[0]);
+
+    size_t limb = start / limbBits, off = start % limbBits;
+    if(limb >= numLimbs)
+        return 0;
+
+    auto w = b.data[limb] >> off;
+    if(off + c > limbBits && limb + 1 < numLimbs)
+        w |= b.data[limb + 1] << (limbBits - off);
+
+    return static_cast<size_t>(w) & ((static_cast<size_t>(1) << c) - 1);
+}
+
+/**
+ * Computes \sum_i bases[i]^{exps[i]} with the bucket method (Pippenger). The exponents are cut
+ * into windows of c bits. For every window, each base is added to the bucket of its c-bit digit
+ * and the buckets are then summed as \sum_d d * B_d with 2 * 2^c additions. Finally, the window
+ * sums are combined with c doublings per window.
+ *
+ * Windows are independent, so the work is split across numThreads as (window, range of bases)
+ * tasks, each with its own buckets. The per-range sums of every window are then added up in
+ * parallel across windows.
+ */
+template<class Group, class Field>
+Group pippengerMultiExp(
+    typename std::vector<Group>::const_iterator base_begin,
+    typename std::vector<Group>::const_iterator base_end,
+    typename std::vector<Field>::const_iterator exp_begin,
+    typename std::vector<Field>::const_iterator exp_end,
+    size_t numThreads)
+{
+    if(base_end - base_begin != exp_end - exp_begin)
+        throw std::runtime_error("pippengerMultiExp needs the same number of bases as exponents");
+
+    size_t n = static_cast<size_t>(base_end - base_begin);
+    if(n == 0)
+        return Group::zero();
+
+    numThreads = std::max<size_t>(numThreads, 1);
+
+    // convert the exponents out of Montgomery form only once
+    typedef decltype(exp_begin->as_bigint()) BigInt;
+    std::vector<BigInt> scalars(n);
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for
+#endif
+    for(size_t i = 0; i < n; i++) {
+        scalars[i] = (exp_begin + static_cast<long>(i))->as_bigint();
+    }
+
+    const size_t c = pippengerWindowSize(n);
+    const size_t numBits = Field::size_in_bits();
+    const size_t numWindows = (numBits + c - 1) / c;
+    const size_t numBuckets = (static_cast<size_t>(1) << c) - 1;
+
+    // if there are fewer windows than threads, also split the bases into ranges, but without
+    // making the ranges so small that summing up the buckets dominates
+    size_t numRanges = (numThreads + numWindows - 1) / numWindows;
+    numRanges = std::max<size_t>(std::min(numRanges, n / (2 * (numBuckets + 1))), 1);
+    const size_t rangeSize = (n + numRanges - 1) / numRanges;
+    const size_t numTasks = numWindows * numRanges;
+
+    std::vector<Group> taskSums(numTasks, Group::zero());
+
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(size_t t = 0; t < numTasks; t++) {
+        size_t w = t / numRanges, r = t % numRanges;
+        size_t begin = r * rangeSize, end = std::min(begin + rangeSize, n);
+
+        std::vector<Group> buckets(numBuckets, Group::zero());
+        for(size_t i = begin; i < end; i++) {
+            size_t d = pippengerDigit(scalars[i], w * c, c);
+            if(d == 0)
+                continue;
+
+            const Group& base = *(base_begin + static_cast<long>(i));
+            Group& bucket = buckets[d - 1];
+            bucket = base.is_special() ? bucket.mixed_add(base) : bucket + base;
+        }
+
+        // \sum_d d * B_d = B_max + (B_max + B_{max-1}) + ... + (B_max + ... + B_1)
+        Group running = Group::zero(), sum = Group::zero();
+        for(size_t d = numBuckets; d > 0; d--) {
+            running = running + buckets[d - 1];
+            sum = sum + running;
+        }
+
+        taskSums[t] = sum;
+    }
+
+    // add up the ranges of every window
+    std::vector<Group> windowSums(numWindows, Group::zero());
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for
+#endif
+    for(size_t w = 0; w < numWindows; w++) {
+        for(size_t r = 0; r < numRanges; r++) {
+            windowSums[w] = windowSums[w] + taskSums[w * numRanges + r];
+        }
+    }
+
+    // combine the windows, from the most significant one down
+    Group result = Group::zero();
+    for(size_t w = numWindows; w > 0; w--) {
+        for(size_t i = 0; i < c; i++) {
+            result = result.dbl();
+        }
+        result = result + windowSums[w - 1];
+    }
+
+    return result;
+}
+
+} // end of namespace libpolycrypto
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <polycrypto/PolyCrypto.h>
+
+namespace libpolycrypto {
+
+/**
+ * Compressed encoding of an elliptic curve point: just its affine x coordinate, as big-endian
+ * base field elements (one for G1, and c0 then c1 for G2's x = c0 + c1 u), with the two top bits
+ * of the first byte used as flags:
+ *
+ *   bit 7: the point at infinity (all other bits must then be zero)
+ *   bit 6: the "sign" of the y coordinate, which picks one of the two square roots: for G1, whether
+ *          y is odd; for G2, whether y.c0 is odd or, if y.c0 = 0, whether y.c1 is odd
+ *
+ * This works because the base field of BN-P254 has a 254-bit modulus, which leaves two bits free.
+ * The encoding is computed from the integer values of the coordinates, so it does not depend on
+ * how libff was built (e.g., with NO_PT_COMPRESSION or BINARY_OUTPUT).
+ *
+ * NOTE: Only implemented for the BN-P254 curves, BN128 and ALT_BN128 (see PointCompression.cpp).
+ * On other curves, compressing or decompressing throws std::runtime_error.
+ */
+const size_t FieldElementBytes = 32;
+
+#if defined(CURVE_BN128) || defined(CURVE_ALT_BN128)
+const bool PointCompressionSupported = true;
+#else
+const bool PointCompressionSupported = false;
+#endif
+
+template<class Group>
+struct CompressedPoint;
+
+template<>
+struct CompressedPoint<G1> {
+    static const size_t NumCoords = 1;
+    static const size_t Size = NumCoords * FieldElementBytes;
+    static const bool HasCofactor = false;  // every point on the curve is in G1
+};
+
+template<>
+struct CompressedPoint<G2> {
+    static const size_t NumCoords = 2;
+    static const size_t Size = NumCoords * FieldElementBytes;
+    static const bool HasCofactor = true;   // the twist has points outside of G2
+};
+
+const size_t G1CompressedSize = CompressedPoint<G1>::Size;
+const size_t G2CompressedSize = CompressedPoint<G2>::Size;
+
+const unsigned char PointInfinityFlag = 0x80;
+const unsigned char PointSignFlag = 0x40;
+
+/**
+ * Writes the affine x coordinate of the non-zero point p to out[0, CompressedPoint<Group>::Size)
+ * and returns the sign of its y coordinate. The top two bits of out[0] are left zero.
+ */
+template<class Group>
+bool compressX(const Group& p, unsigned char * out);
+
+/**
+ * Returns the point with the x coordinate at in[0, CompressedPoint<Group>::Size), ignoring the
+ * flags in in[0], and with the given sign of y. Throws std::runtime_error if x is not canonical
+ * or if x^3 + b is not a square, i.e., if there is no such point on the curve.
+ */
+template<class Group>
+Group decompressX(const unsigned char * in, bool sign);
+
+template<> bool compressX<G1>(const G1& p, unsigned char * out);
+template<> bool compressX<G2>(const G2& p, unsigned char * out);
+template<> G1 decompressX<G1>(const unsigned char * in, bool sign);
+template<> G2 decompressX<G2>(const unsigned char * in, bool sign);
+
+/**
+ * Writes the CompressedPoint<Group>::Size-byte encoding of p to out.
+ */
+template<class Group>
+void compressPoint(const Group& p, unsigned char * out) {
+    std::fill(out, out + CompressedPoint<Group>::Size, static_cast<unsigned char>(0));
+
+    if(p.is_zero()) {
+        out[0] = PointInfinityFlag;
+        return;
+    }
+
+    if(compressX<Group>(p, out)) {
+        out[0] = static_cast<unsigned char>(out[0] | PointSignFlag);
+    }
+}
+
+/**
+ * Reads a point from its CompressedPoint<Group>::Size-byte encoding at in. Throws
+ * std::runtime_error if the encoding is malformed or is not a point on the curve or,
+ * when checkSubgroup is true, if the point is not in the group (i.e., in the r-torsion).
+ *
+ * The subgroup check is a scalar multiplication by r for G2, so it should only be skipped
+ * for trusted inputs (e.g., the public parameters).
+ */
+template<class Group>
+Group decompressPoint(const unsigned char * in, bool checkSubgroup = true) {
+    const unsigned char flags = static_cast<unsigned char>(in[0] & (PointInfinityFlag | PointSignFlag));
+
+    if(flags & PointInfinityFlag) {
+        if(flags & PointSignFlag)
+            throw std::runtime_error("Point at infinity cannot have the sign flag set");
+
+        for(size_t i = 1; i < CompressedPoint<Group>::Size; i++)
+            if(in[i] != 0)
+                throw std::runtime_error("Point at infinity must be encoded as all zeros");
+        if((in[0] & ~PointInfinityFlag) != 0)
+            throw std::runtime_error("Point at infinity must be encoded as all zeros");
+
+        return Group::zero();
+    }
+
+    Group p = decompressX<Group>(in, (flags & PointSignFlag) != 0);
+    if(!p.is_well_formed()) {
+        throw std::runtime_error("Compressed point is not on the curve");
+    }
+
+    if(checkSubgroup && CompressedPoint<Group>::HasCofactor && !(Group::order() * p).is_zero()) {
+        throw std::runtime_error("Compressed point is on the curve, but not in the group");
+    }
+
+    return p;
+}
+
+/**
+ * Compresses all points in [begin, end) into out, which must have room for
+ * (end - begin) * CompressedPoint<Group>::Size bytes.
+ *
+ * NOTE: compressPoint() only throws on curves without point compression, which we check
+ * before spreading the points across threads.
+ */
+template<class Group>
+void compressPoints(
+    typename std::vector<Group>::const_iterator begin,
+    typename std::vector<Group>::const_iterator end,
+    unsigned char * out)
+{
+    size_t count = static_cast<size_t>(end - begin);
+    if(!PointCompressionSupported && count > 0) {
+        throw std::runtime_error("Point compression is only implemented for the BN-P254 curves");
+    }
+
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for
+#endif
+    for(size_t i = 0; i < count; i++) {
+        compressPoint<Group>(*(begin + static_cast<long>(i)), out + i * CompressedPoint<Group>::Size);
+    }
+}
+
+template<class Group>
+std::vector<unsigned char> compressPoints(const std::vector<Group>& points) {
+    std::vector<unsigned char> buf(points.size() * CompressedPoint<Group>::Size);
+    compressPoints<Group>(points.cbegin(), points.cend(), buf.data());
+    return buf;
+}
+
+/**
+ * Decompresses points.size() consecutive compressed points at 'in' into 'points'.
+ * Decompression costs a square root per point, so the points are split across threads.
+ * Throws std::runtime_error if any of them is malformed (see decompressPoint()).
+ */
+template<class Group>
+void decompressPoints(const unsigned char * in, std::vector<Group>& points, bool checkSubgroup = true) {
+    // NOTE: exceptions cannot leave an OpenMP parallel region
+    bool failed = false;
+    std::string error;
+
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for
+#endif
+    for(size_t i = 0; i < points.size(); i++) {
+        try {
+            points[i] = decompressPoint<Group>(in + i * CompressedPoint<Group>::Size, checkSubgroup);
+        } catch(const std::exception& e) {
+#ifdef USE_MULTITHREADING
+#pragma omp critical
+#endif
+            {
+                failed = true;
+                error = e.what();
+            }
+        }
+    }
+
+    if(failed) {
+        throw std::runtime_error(error);
+    }
+}
+
+template<class Group>
+std::vector<Group> decompressPoints(const std::vector<unsigned char>& buf, bool checkSubgroup = true) {
+    if(buf.size() % CompressedPoint<Group>::Size != 0) {
+        throw std::runtime_error("Buffer size is not a multiple of the compressed point size");
+    }
+
+    std::vector<Group> points(buf.size() / CompressedPoint<Group>::Size);
+    decompressPoints<Group>(buf.data(), points, checkSubgroup);
+    return points;
+}
+
+} // end of namespace libpolycrypto
@@ -1,9 +1,15 @@
 #pragma once
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
 #include <libff/algebra/curves/public_params.hpp>
 #include <libff/common/default_types/ec_pp.hpp>
 #include <libff/algebra/scalar_multiplication/multiexp.hpp>
 
+#include <polycrypto/Pippenger.h>
+
 #include <xassert/XAssert.h>
 
 using namespace std;
@@ -30,6 +36,63 @@ auto ReducedPairing(
     return libff::default_ec_pp::reduced_pairing(std::forward<Args>(args)...);
 }
 
+// Type of the output of a Miller loop, which is only an element of GT after the final exponentiation
+using Fqk = typename libff::default_ec_pp::Fqk_type;
+
+/**
+ * A G2 element with the line coefficients of its Miller loops precomputed, which is about half the
+ * work of a pairing. Pairings with a fixed G2 argument (e.g., g2, g2^s or a player's verification key)
+ * should prepare it once and reuse it, so that every pairing only does the G1 half.
+ */
+class PreparedG2 {
+protected:
+    bool isZero;
+    typename libff::default_ec_pp::G2_precomp_type prec;
+
+public:
+    PreparedG2();
+    explicit PreparedG2(const G2& q);
+
+public:
+    bool is_zero() const { return isZero; }
+
+    const typename libff::default_ec_pp::G2_precomp_type& getLineCoeffs() const { return prec; }
+};
+
+/**
+ * Returns g2 = G2::one(), prepared. It is computed the first time this is called.
+ */
+const PreparedG2& preparedG2One();
+
+/**
+ * Returns the Miller loop of e(p, q), without the final exponentiation.
+ */
+Fqk MillerLoop(const G1& p, const G2& q);
+
+Fqk MillerLoop(const G1& p, const PreparedG2& q);
+
+/**
+ * Returns the product of the Miller loops of e(ps[i], qs[i]), two at a time, so that each pair
+ * shares the squarings of its loop.
+ */
+Fqk MultiMillerLoop(const std::vector<G1>& ps, const std::vector<G2>& qs);
+
+Fqk MultiMillerLoop(const std::vector<G1>& ps, const std::vector<const PreparedG2*>& qs);
+
+/**
+ * Maps the output of (products of) Miller loops to GT.
+ */
+GT FinalExponentiation(const Fqk& f);
+
+/**
+ * Returns \prod_i e(ps[i], qs[i]) with a single final exponentiation, rather than one per pairing.
+ * To check that \prod_i e(ps[i], qs[i]) = \prod_j e(ps'[j], qs'[j]), negate the ps' and check that
+ * the product of all the pairings is GT::one().
+ */
+GT MultiPairing(const std::vector<G1>& ps, const std::vector<G2>& qs);
+
+GT MultiPairing(const std::vector<G1>& ps, const std::vector<const PreparedG2*>& qs);
+
 /**
  * Initializes the library, including its randomness.
  */
@@ -62,7 +125,30 @@ vector<Fr> get_all_roots_of_unity(size_t n);
 //vector<Fr> random_poly(size_t degree);
 
 /**
- * Performs a multi-exponentiation using libfqfft
+ * The multiexp sizes at which multiExp() switches from one method to the next, for one group.
+ * The defaults can be replaced by a per-machine profile (see MultiExpProfile.h).
+ */
+struct MultiExpThresholds {
+    size_t bosCoster;   // use Bos-Coster from this many exponentiations on (naive below)
+    size_t bdlo12;      // use BDLO12 from this many on
+    size_t pippenger;   // use our Pippenger (see Pippenger.h) on all cores from this many on
+};
+
+/**
+ * Returns the thresholds multiExp() uses for the Group (G1 or G2).
+ */
+template<class Group>
+MultiExpThresholds& getMultiExpThresholds();
+
+template<>
+MultiExpThresholds& getMultiExpThresholds<G1>();
+
+template<>
+MultiExpThresholds& getMultiExpThresholds<G2>();
+
+/**
+ * Performs a multi-exponentiation using libff or our parallel Pippenger, picking the method
+ * based on the size of the multiexp (see MultiExpThresholds).
  */
 template<class Group>
 Group multiExp(
@@ -76,16 +162,19 @@ Group multiExp(
     long expsz = exp_end - exp_begin;
     if(sz != expsz)
         throw std::runtime_error("multiExp needs the same number of bases as exponents");
-    //size_t numCores = getNumCores();
-
-    if(sz > 4) {
-        if(sz > 16384) {
-            return libff::multi_exp<Group, Fr, libff::multi_exp_method_BDLO12>(base_begin, base_end,
-                exp_begin, exp_end, 1);//numCores);
-        } else {
-            return libff::multi_exp<Group, Fr, libff::multi_exp_method_bos_coster>(base_begin, base_end,
-                exp_begin, exp_end, 1);//numCores);
-        }
+
+    const MultiExpThresholds& th = getMultiExpThresholds<Group>();
+    size_t n = static_cast<size_t>(sz);
+
+    // NOTE: libff's own multiexps are sequential (the chunk count below is 1)
+    if(n >= th.pippenger) {
+        return pippengerMultiExp<Group, Fr>(base_begin, base_end, exp_begin, exp_end, getNumCores());
+    } else if(n >= th.bdlo12) {
+        return libff::multi_exp<Group, Fr, libff::multi_exp_method_BDLO12>(base_begin, base_end,
+            exp_begin, exp_end, 1);
+    } else if(n >= th.bosCoster) {
+        return libff::multi_exp<Group, Fr, libff::multi_exp_method_bos_coster>(base_begin, base_end,
+            exp_begin, exp_end, 1);
     } else {
         return libff::multi_exp<Group, Fr, libff::multi_exp_method_naive>(base_begin, base_end,
             exp_begin, exp_end, 1);
@@ -105,6 +194,86 @@ Group multiExp(
         exps.cbegin(), exps.cend());
 }
 
+/**
+ * The default grain size of scheduleMultiExps(), in exponentiations: tiny multiexps (e.g., the
+ * size-1 quotients at the leaves of an AMT) are grouped into tasks of at least this many.
+ */
+const size_t MultiExpGrainSize = 16;
+
+/**
+ * Schedules many independent multiexps, of sizes[j] exponentiations each, by calling job(j).
+ * Multiexps that are more than a core's share of the total work are run one at a time, so that
+ * they can use all cores themselves. The rest run in parallel with each other, largest first, so
+ * that no thread is left with a big one at the end, in tasks of consecutive multiexps that add
+ * up to at least grainSize exponentiations, so that small ones are not scheduled one by one.
+ */
+template<class Job>
+void scheduleMultiExps(const std::vector<size_t>& sizes, const Job& job, size_t grainSize = MultiExpGrainSize) {
+    std::vector<size_t> order(sizes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) {
+        return sizes[a] > sizes[b];
+    });
+
+    size_t total = std::accumulate(sizes.begin(), sizes.end(), static_cast<size_t>(0));
+    size_t numCores = getNumCores();
+
+    size_t firstSmall = 0;
+    while(firstSmall < order.size() && sizes[order[firstSmall]] * numCores > total) {
+        job(order[firstSmall]);
+        firstSmall++;
+    }
+
+    // task i does the multiexps order[taskStart[i], taskStart[i+1])
+    std::vector<size_t> taskStart;
+    size_t taskSize = grainSize;
+    for(size_t k = firstSmall; k < order.size(); k++) {
+        if(taskSize >= grainSize) {
+            taskStart.push_back(k);
+            taskSize = 0;
+        }
+        taskSize += sizes[order[k]];
+    }
+    taskStart.push_back(order.size());
+
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(size_t i = 0; i < taskStart.size() - 1; i++) {
+        for(size_t k = taskStart[i]; k < taskStart[i + 1]; k++) {
+            job(order[k]);
+        }
+    }
+}
+
+/**
+ * Performs many multiexps over prefixes of the same bases: the jth result is the multiexp of
+ * the first exps[j]->size() bases with the exponents in *exps[j]. This is much faster than
+ * calling multiExp() for each one when there are many small ones (e.g., the quotient commitments
+ * in an AMT), since they are spread across threads. Poly can be std::vector<Fr> or a PolySlice<Fr>.
+ */
+template<class Group, class Poly>
+std::vector<Group> multiExpBatch(
+    const std::vector<Group>& bases,
+    const std::vector<const Poly*>& exps,
+    size_t grainSize = MultiExpGrainSize)
+{
+    std::vector<size_t> sizes(exps.size());
+    for(size_t j = 0; j < exps.size(); j++) {
+        sizes[j] = exps[j]->size();
+        if(sizes[j] > bases.size())
+            throw std::runtime_error("multiExpBatch needs at least as many bases as exponents in every multiexp");
+    }
+
+    std::vector<Group> results(exps.size(), Group::zero());
+    scheduleMultiExps(sizes, [&](size_t j) {
+        results[j] = multiExp<Group>(bases.cbegin(), bases.cbegin() + static_cast<long>(sizes[j]),
+            exps[j]->cbegin(), exps[j]->cend());
+    }, grainSize);
+
+    return results;
+}
+
 } // end of namespace libpolycrypto
 
 namespace boost {
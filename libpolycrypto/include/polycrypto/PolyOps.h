@@ -7,6 +7,7 @@
 #include <iostream>
 
 #include <polycrypto/NtlLib.h>
+#include <polycrypto/FFT.h>
 #include <libfqfft/polynomial_arithmetic/basic_operations.hpp>
 
 #include <xassert/XAssert.h>
@@ -88,6 +89,51 @@ public:
 XncPoly operator*(const XncPoly& lhs, const XncPoly& rhs);
 std::ostream& operator<<(std::ostream& out, const XncPoly& rhs);
 
+/**
+ * A polynomial whose len coefficients are stored at [offset, offset + len) in a bigger vector,
+ * which holds many polynomials back to back, so that they all live in a single allocation
+ * (e.g., the quotients and remainders of a RootsOfUnityEvaluation). Like a span, copying it does
+ * not copy the coefficients, and it is only valid as long as the vector it points into.
+ */
+template<class FieldT>
+class PolySlice {
+public:
+    typedef typename std::vector<FieldT>::iterator iterator;
+    typedef typename std::vector<FieldT>::const_iterator const_iterator;
+
+protected:
+    std::vector<FieldT> * arena;
+    size_t offset;
+    size_t len;
+
+public:
+    PolySlice() : arena(nullptr), offset(0), len(0) {}
+
+    PolySlice(std::vector<FieldT>& arena, size_t offset, size_t len)
+        : arena(&arena), offset(offset), len(len)
+    {
+        assertLessThanOrEqual(offset + len, arena.size());
+    }
+
+public:
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+
+    FieldT& operator[](size_t i) const { return (*arena)[offset + i]; }
+
+    FieldT * data() const { return arena->data() + offset; }
+
+    iterator begin() const { return arena->begin() + static_cast<long>(offset); }
+    iterator end() const { return begin() + static_cast<long>(len); }
+    // NOTE: these are std::vector iterators, so slices can be passed to multiExp() and commitBatch()
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    std::vector<FieldT> toVector() const {
+        return len == 0 ? std::vector<FieldT>() : std::vector<FieldT>(begin(), end());
+    }
+};
+
 /**
  * Does an FFT: i.e., evaluates and returns p(\omega^i) for all i = 0, ..., N-1
  * 
@@ -96,19 +142,8 @@ std::ostream& operator<<(std::ostream& out, const XncPoly& rhs);
 template<class FieldT>
 void poly_fft(const std::vector<FieldT>& p, size_t N, std::vector<FieldT>& vals) {
     assertTrue(Utils::isPowerOfTwo(N));
-    FieldT omega = libff::get_root_of_unity<FieldT>(N);
 
-    if(N < p.size())
-        throw std::runtime_error("N has to be greater than polynomial degree");
-
-    vals = p;
-    vals.resize(N, FieldT::zero());
-
-#ifdef MULTICORE
-    _basic_parallel_radix2_FFT(vals, omega);
-#else
-    _basic_serial_radix2_FFT(vals, omega);
-#endif
+    libpolycrypto::fft(p, N, vals);
 }
 
 // WARNING: Slower than NTL::BuildFromRoots(), but not sure why
@@ -210,10 +245,55 @@ bool poly_is_xnc(const vector<FieldT>& p) {
     return true;
 }
 
+/**
+ * Divides a(X) = a[0] + ... + a[aLen-1] X^{aLen-1} by b(X) = X^m + b.c, with m > 0, writing the
+ * quotient's aLen - m coefficients to q (none if aLen <= m) and the remainder's min(aLen, m)
+ * coefficients to r. Does not allocate anything. r can be the same buffer as a, but q cannot.
+ *
+ * The quotient coefficients satisfy q_j = a_{j+m} - c q_{j+m}, so every q_j only depends on the
+ * one m positions higher, and the remainder is r_j = a_j - c q_j, for j < m. So, unlike
+ * poly_divide_xnc_slow(), we never copy a or shrink r, and consecutive iterations of the loops
+ * below are independent.
+ */
+template<class FieldT>
+void poly_divide_xnc(const FieldT * a, size_t aLen, const XncPoly& b, FieldT * q, FieldT * r) {
+    const size_t m = b.n;
+    const FieldT& c = b.c;
+    assertStrictlyGreaterThan(m, 0);
+
+    if(aLen <= m) {
+        if(r != a)
+            std::copy(a, a + aLen, r);
+        return;
+    }
+
+    // the top m quotient coefficients are just the top coefficients of a
+    const size_t qLen = aLen - m;
+    const size_t top = qLen > m ? qLen - m : 0;
+    for(size_t j = top; j < qLen; j++) {
+        q[j] = a[j + m];
+    }
+
+    // the rest of the quotient
+    for(size_t j = top; j-- > 0; ) {
+        q[j] = a[j + m] - c * q[j + m];
+    }
+
+    // the remainder is what is left of a's bottom m coefficients
+    const size_t low = std::min(m, qLen);
+    for(size_t j = 0; j < low; j++) {
+        r[j] = a[j] - c * q[j];
+    }
+    for(size_t j = low; j < m; j++) {
+        r[j] = a[j];
+    }
+}
+
 /**
  * Divides a(X) (of degree n) by b(X) of (degree m), where b(X) is of the form X^m - c.
  *
- * Returns the quotient in q and the remainder in r.
+ * Returns the quotient in q and the remainder in r. Only resizes q and r once, so they do not
+ * allocate at all if they already have enough capacity (e.g., when reused across calls).
  */
 template<class FieldT>
 void poly_divide_xnc(const vector<FieldT>& a, const XncPoly& b, vector<FieldT>& q, vector<FieldT>& r) {
@@ -226,6 +306,30 @@ void poly_divide_xnc(const vector<FieldT>& a, const XncPoly& b, vector<FieldT>&
         return;
     }
 
+    q.resize(a.size() - b.n);
+    r.resize(b.n);
+    poly_divide_xnc(a.data(), a.size(), b, q.data(), r.data());
+}
+
+/**
+ * Divides a(X) (of degree n) by b(X) of (degree m), where b(X) is of the form X^m - c.
+ *
+ * Returns the quotient in q and the remainder in r.
+ *
+ * This is the original, naive version, which shrinks r by one coefficient per quotient coefficient.
+ * We keep it as a reference for poly_divide_xnc() (see bench/BenchPolyDivideXnc.cpp).
+ */
+template<class FieldT>
+void poly_divide_xnc_slow(const vector<FieldT>& a, const XncPoly& b, vector<FieldT>& q, vector<FieldT>& r) {
+    assertStrictlyGreaterThan(a.size(), 0);
+
+    if(a.size() < b.n + 1) {
+        q.resize(1);
+        q[0] = 0;
+        r = a;
+        return;
+    }
+
     size_t n = a.size() - 1;
     size_t m = b.n; // the degree of the xnc poly
     FieldT c = b.c;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <polycrypto/PolyCrypto.h>
+#include <polycrypto/ScalarMult.h>
 
 #include <vector>
 #include <cmath>
@@ -26,46 +27,156 @@ namespace libpolycrypto {
 
 /**
  * Polynomials stored in the multipoint evaluation tree: quotient and remainder.
+ * Their coefficients live in the tree's arena (see RootsOfUnityEvaluation::coeffs).
  */
 class EvalPolys {
 public:
-    std::vector<Fr> quo;
-    std::vector<Fr> rem;  // the remainders are not part of the proof, but we need them to compute quotients (and to get the final evaluations)
+    PolySlice<Fr> quo;
+    PolySlice<Fr> rem;  // the remainders are not part of the proof, but we need them to compute quotients (and to get the final evaluations)
 };
 
+/**
+ * Subtrees of the (binary) multipoint evaluation tree rooted at this level or below are computed serially,
+ * by one thread: each has 2^10 leaves, which is enough work to amortize scheduling it, and there
+ * are still N / 2^10 of them to balance across the cores.
+ */
+const size_t RootsOfUnityEvalSerialLevel = 10;
+
 /**
  * Class used to evaluate a polynomial at the first n Nth roots of unity.
  * n is given as a parameter and N = 2^k is the smallest number such that n <= N.
  *
- * TODO: can be multithreaded
+ * The tree can have any arity q = 2^b: its level k then uses the accumulators x^{2^{bk}} - c at
+ * level bk of the (binary) AccumulatorTree, since these are the products of the q accumulators b
+ * levels below. A higher arity gives a shorter tree, at the cost of bigger quotients.
+ *
+ * The tree is computed in parallel (see BinaryTree::traversePreorderParallel).
  */
 class RootsOfUnityEvaluation : public BinaryTree<EvalPolys> {
 protected:
     const AccumulatorTree& accs;
 
+    /**
+     * The coefficients of all quotients and remainders in the tree, back to back, level by level
+     * from the root(s) down. Their sizes only depend on the degree of f, so they are all allocated
+     * at once, before dividing.
+     */
+    std::vector<Fr> coeffs;
+
 public:
     /**
      * Executes an O(n \log{n}) multipoint evaluation of a polynomial f on the first n Nth roots-of-unity points (given in 'accs')
      *
      * @param   poly    the polynomial f being evaluated
      * @param   accs    the points to evaluate f at (wrapped as an AccumulatorTree)
+     * @param   arity   the number of children of every node, a power of two
      */
-    RootsOfUnityEvaluation(const std::vector<Fr>& poly, const AccumulatorTree& accs)
+    RootsOfUnityEvaluation(const std::vector<Fr>& poly, const AccumulatorTree& accs, size_t arity = 2)
         : accs(accs)
     {
         size_t n = accs.getNumPoints();
         size_t N = accs.getNumLeaves();
         size_t t = poly.size();
-        // it could be that t >> n
-        size_t rootLevel = std::min(Utils::log2floor(t-1), accs.getNumLevels() - 1);
+        size_t rootLevel = getRootLevel(t, accs, arity);
 
         assertStrictlyGreaterThan(n, 1);
-        allocateTree(N, rootLevel);
+        allocateTree(N, rootLevel, arity);
+        allocateCoeffs(t, rootLevel);
 
         computeQuotients(poly, rootLevel);
     }
 
+    // the quotients and remainders point into this tree's arena, so the tree cannot be copied
+    RootsOfUnityEvaluation(const RootsOfUnityEvaluation&) = delete;
+    RootsOfUnityEvaluation& operator=(const RootsOfUnityEvaluation&) = delete;
+
+public:
+    /**
+     * Returns the level of the root(s) of the tree for a polynomial with t coefficients: the
+     * accumulators above it have degree > t - 1, so they would leave f unchanged.
+     */
+    static size_t getRootLevel(size_t t, const AccumulatorTree& accs, size_t arity = 2) {
+        // it could be that t >> n
+        return std::min(Utils::log2floor(t-1), accs.getNumLevels() - 1) / Utils::log2floor(checkArity(arity));
+    }
+
+    /**
+     * Returns the accumulator of node idx at level k of a tree with the specified arity.
+     */
+    static const XncPoly& getAccumulator(const AccumulatorTree& accs, size_t arity, size_t k, size_t idx) {
+        return accs.getPoly(k * Utils::log2floor(arity), idx);
+    }
+
+    const XncPoly& getAccumulator(size_t k, size_t idx) const {
+        return getAccumulator(accs, arity, k, idx);
+    }
+
+    /**
+     * Returns the sizes of the quotient and of the remainder of a polynomial with aLen coefficients
+     * divided by b, as poly_divide_xnc() outputs them.
+     */
+    static std::pair<size_t, size_t> getDivisionSizes(size_t aLen, const XncPoly& b) {
+        size_t m = b.n;
+        return aLen < m + 1 ? std::pair<size_t, size_t>(1, aLen) : std::pair<size_t, size_t>(aLen - m, m);
+    }
+
+    /**
+     * Divides a by b into the node's quotient and remainder, which are already allocated.
+     */
+    static void divide(const Fr * a, size_t aLen, const XncPoly& b, EvalPolys& node) {
+        // same as poly_divide_xnc() on vectors: a quotient of zero when a has a smaller degree than b
+        if(aLen < b.n + 1)
+            node.quo[0] = Fr::zero();
+
+        poly_divide_xnc(a, aLen, b, node.quo.data(), node.rem.data());
+    }
+
 protected:
+    /**
+     * Sizes the quotient and remainder of every node, as poly_divide_xnc() would, and carves them
+     * out of the arena.
+     */
+    void allocateCoeffs(size_t t, size_t rootLevel) {
+        size_t n = accs.getNumPoints();
+        size_t numBits = getNumBits();
+
+        // sizes[k][idx] = (quotient size, remainder size) of node idx at level k
+        TreeLevels<std::pair<size_t, size_t>> sizes;
+        sizes.allocate(getNumLeaves(), tree.size(), arity);
+
+        size_t total = 0;
+        for(size_t k = rootLevel + 1; k-- > 0; ) {
+            for(size_t idx = 0; idx < tree[k].size(); idx++) {
+                // no need to compute quotient/remainder for the ith leaf if bitreverse(i) >= n
+                if(k == 0 && libff::bitreverse(idx, numBits) >= n)
+                    continue;
+
+                size_t a = k == rootLevel ? t : sizes[k + 1][idx / arity].second;
+                sizes[k][idx] = getDivisionSizes(a, getAccumulator(k, idx));
+                total += sizes[k][idx].first + sizes[k][idx].second;
+            }
+        }
+
+        coeffs.resize(total);
+        carveCoeffs(sizes);
+    }
+
+    /**
+     * Points every node's quotient and remainder at its slice of the arena, given their sizes.
+     */
+    void carveCoeffs(const TreeLevels<std::pair<size_t, size_t>>& sizes) {
+        size_t offset = 0;
+        for(size_t k = tree.size(); k-- > 0; ) {
+            for(size_t idx = 0; idx < tree[k].size(); idx++) {
+                tree[k][idx].quo = PolySlice<Fr>(coeffs, offset, sizes[k][idx].first);
+                offset += sizes[k][idx].first;
+                tree[k][idx].rem = PolySlice<Fr>(coeffs, offset, sizes[k][idx].second);
+                offset += sizes[k][idx].second;
+            }
+        }
+        assertEqual(offset, coeffs.size());
+    }
+
     void computeQuotients(const std::vector<Fr>& f, size_t rootLevel) {
         assertStrictlyGreaterThan(tree.size(), 0);
         size_t n = accs.getNumPoints();
@@ -73,17 +184,19 @@ protected:
 
         // compute the root(s) of the multipoint evaluation tree
         size_t numRoots = tree.back().size();
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for if(numRoots > 1)
+#endif
         for(size_t idx = 0; idx < numRoots; idx++) {
-            poly_divide_xnc(
-                f,
-                accs.getPoly(rootLevel, idx),
-                tree[rootLevel][idx].quo,
-                tree[rootLevel][idx].rem
-            );
+            // the roots can be leaves too, when f is a constant
+            if(rootLevel == 0 && libff::bitreverse(idx, numBits) >= n)
+                continue;
+
+            divide(f.data(), f.size(), getAccumulator(rootLevel, idx), tree[rootLevel][idx]);
         }
 
-        // compute the rest of the tree
-        traversePreorder([rootLevel, n, numBits, this](size_t k, size_t idx) {
+        // compute the rest of the tree: a node only needs its parent's remainder, so subtrees are done in parallel
+        traversePreorderParallel([rootLevel, n, numBits, this](size_t k, size_t idx) {
             // the root is a special case and was computed above
             if(k == rootLevel)
                 return;
@@ -94,13 +207,9 @@ protected:
                 return;
 
             // divides the parent remainder poly by the accumulator of the current node
-            poly_divide_xnc(
-                tree[k+1][idx / 2].rem,
-                accs.getPoly(k, idx),
-                tree[k][idx].quo,
-                tree[k][idx].rem
-            );
-        });
+            auto& parentRem = tree[k+1][idx / arity].rem;
+            divide(parentRem.data(), parentRem.size(), getAccumulator(k, idx), tree[k][idx]);
+        }, RootsOfUnityEvalSerialLevel / Utils::log2floor(arity));
     }
 
 public:
@@ -141,20 +250,66 @@ public:
         }
     }
 
+    /**
+     * Turns this into the multipoint evaluation of f + g, where f is the polynomial evaluated
+     * by this tree and g is the one evaluated by rhs. The two trees must have the same root
+     * level, but f and g can have different degrees.
+     */
     RootsOfUnityEvaluation& operator+=(const RootsOfUnityEvaluation& rhs) {
         if(accs != rhs.accs) {
             throw std::runtime_error("Can only merge multipoint evaluations if they were done at the same set of points");
         }
 
+        if(arity != rhs.arity) {
+            throw std::runtime_error("Can only merge multipoint evaluations with trees of the same arity");
+        }
+
         assertEqual(tree.size(), rhs.tree.size());
 
+        // polynomials of the same degree have the same quotient and remainder sizes, so their arenas line up
+        if(coeffs.size() == rhs.coeffs.size()) {
+            for(size_t i = 0; i < coeffs.size(); i++) {
+                coeffs[i] += rhs.coeffs[i];
+            }
+
+            return *this;
+        }
 
+        // otherwise, the polynomials of one tree can be longer than the other's, so we add them node by node into a new arena
+        TreeLevels<std::pair<size_t, size_t>> sizes;
+        sizes.allocate(getNumLeaves(), tree.size(), arity);
+
+        size_t total = 0;
         for(size_t k = 0; k < tree.size(); k++) {
-            for (size_t i = 0; i < tree[k].size(); i++) {
-                libfqfft::_polynomial_addition(tree[k][i].quo, tree[k][i].quo, rhs.tree[k][i].quo);
-                libfqfft::_polynomial_addition(tree[k][i].rem, tree[k][i].rem, rhs.tree[k][i].rem);
+            for(size_t idx = 0; idx < tree[k].size(); idx++) {
+                sizes[k][idx].first = std::max(tree[k][idx].quo.size(), rhs.tree[k][idx].quo.size());
+                sizes[k][idx].second = std::max(tree[k][idx].rem.size(), rhs.tree[k][idx].rem.size());
+                total += sizes[k][idx].first + sizes[k][idx].second;
+            }
+        }
+
+        std::vector<Fr> merged(total, Fr::zero());
+        size_t offset = 0;
+        // adds a and b into merged[offset, offset + max(|a|, |b|)), in the same order carveCoeffs() lays them out
+        auto add = [&merged, &offset](const PolySlice<Fr>& a, const PolySlice<Fr>& b) {
+            for(size_t i = 0; i < a.size(); i++)
+                merged[offset + i] += a[i];
+            for(size_t i = 0; i < b.size(); i++)
+                merged[offset + i] += b[i];
+
+            offset += std::max(a.size(), b.size());
+        };
+
+        for(size_t k = tree.size(); k-- > 0; ) {
+            for(size_t idx = 0; idx < tree[k].size(); idx++) {
+                add(tree[k][idx].quo, rhs.tree[k][idx].quo);
+                add(tree[k][idx].rem, rhs.tree[k][idx].rem);
             }
         }
+        assertEqual(offset, total);
+
+        coeffs.swap(merged);
+        carveCoeffs(sizes);
 
         return *this;
     }
@@ -189,45 +344,30 @@ public:
         size_t n = getNumPoints();
 
         // Check polynomials are correctly computed in the multipoint evaluation tree
-        // (e.g., for left child check if acc[k-1][2i]*quo[k-1][2i] + rem[k-1][2i] =?= rem[k][i])
+        // (e.g., for the cth child check if acc[k-1][q*i+c]*quo[k-1][q*i+c] + rem[k-1][q*i+c] =?= rem[k][i])
         std::vector<Fr> parent;
+        bool childrenCheck = true;
+        for(size_t c = arity*idx; c < arity*idx + arity; c++) {
+            // Check the child, if it's a leaf for a \omega^i point we care about
+            if(k - 1 != 0 || libff::bitreverse(c, numBits) < n) {
+                libfqfft::_polynomial_multiplication_on_fft(parent,
+                    getAccumulator(k - 1, c).toLibff(),
+                    tree[k-1][c].quo.toVector());
+
+                libfqfft::_polynomial_addition(parent,
+                    parent,
+                    tree[k-1][c].rem.toVector());
+
+                if(parent != tree[k][idx].rem.toVector())
+                    return false;
+
+                //logdbg << "Child is consistent at level=" << k-1 << ", idx=" << c << endl;
+            }
 
-        // Check left child, if it's a leaf for a \omega^i point we care about
-        if(k - 1 != 0 || libff::bitreverse(2*idx, numBits) < n) {
-            libfqfft::_polynomial_multiplication_on_fft(parent,
-                accs.getPoly(k - 1, 2*idx).toLibff(),
-                tree[k-1][2*idx].quo);
-
-            libfqfft::_polynomial_addition(parent,
-                parent,
-                tree[k-1][2*idx].rem);
-
-            if(parent != tree[k][idx].rem)
-                return false;
-
-            //logdbg << "Left child is consistent at level=" << k-1 << ", idx=" << 2*idx << endl;
-        }
-
-        // Check right child, if it's a leaf for a \omega^i point we care about
-        if(k - 1 != 0 || libff::bitreverse(2*idx + 1, numBits) < n) {
-            libfqfft::_polynomial_multiplication_on_fft(parent,
-                accs.getPoly(k - 1, 2*idx + 1).toLibff(),
-                tree[k-1][2*idx + 1].quo);
-
-            libfqfft::_polynomial_addition(parent,
-                parent,
-                tree[k-1][2*idx + 1].rem);
-
-            if(parent != tree[k][idx].rem)
-                return false;
-            
-            //logdbg << "Right child is consistent at level=" << k-1 << ", idx=" << 2*idx+1 << endl;
+            childrenCheck = _testIsConsistent(k-1, c) && childrenCheck;
         }
 
-        bool rightCheck = _testIsConsistent(k-1, 2*idx + 1),
-            leftCheck = _testIsConsistent(k-1, 2*idx);
-
-        return leftCheck && rightCheck;
+        return childrenCheck;
     }
 };
 
@@ -240,16 +380,43 @@ protected:
     const KatePublicParameters& kpp;
 
 public:
-    AuthRootsOfUnityEvaluation(const RootsOfUnityEvaluation& eval, const KatePublicParameters& kpp, bool simulate)
+    /**
+     * @param grainSize     the commitments are computed in parallel, in tasks of at least this many
+     *                      exponentiations (see scheduleMultiExps)
+     */
+    AuthRootsOfUnityEvaluation(const RootsOfUnityEvaluation& eval, const KatePublicParameters& kpp, bool simulate,
+        size_t grainSize = MultiExpGrainSize)
         : kpp(kpp)
     {
-        allocateTree(eval.getNumLeaves(), eval.getMaxLevel());
-        authenticate(eval, simulate);
+        allocateTree(eval.getNumLeaves(), eval.getMaxLevel(), eval.getArity());
+        authenticate(eval, simulate, grainSize);
+    }
+
+    /**
+     * Evaluates f at the first n Nth roots of unity (given in 'accs') and commits to every quotient
+     * as soon as its level is computed, from the root(s) down. Unlike authenticating a
+     * RootsOfUnityEvaluation, which keeps all O(N \log{t}) quotient and remainder coefficients
+     * alive, this only stores one level of quotients and two levels of remainders, or O(N).
+     *
+     * @param   evals   set to f(w_N^i), for i = 0, ..., n-1
+     * @param   arity   the number of children of every node, a power of two
+     */
+    AuthRootsOfUnityEvaluation(const std::vector<Fr>& f, const AccumulatorTree& accs, const KatePublicParameters& kpp,
+        bool simulate, std::vector<Fr>& evals, size_t arity = 2, size_t grainSize = MultiExpGrainSize)
+        : kpp(kpp)
+    {
+        assertStrictlyGreaterThan(accs.getNumPoints(), 1);
+        allocateTree(accs.getNumLeaves(), RootsOfUnityEvaluation::getRootLevel(f.size(), accs, arity), arity);
+        authenticateStreaming(f, accs, simulate, evals, grainSize);
     }
 
 protected:
-    void authenticate(const RootsOfUnityEvaluation& eval, bool simulate) {
-        traversePreorder([eval, simulate, this](size_t k, size_t idx) {
+    void authenticate(const RootsOfUnityEvaluation& eval, bool simulate, size_t grainSize) {
+        // the nodes whose quotients we commit to, and the quotients themselves
+        std::vector<std::pair<size_t, size_t>> nodes;
+        std::vector<const PolySlice<Fr>*> quos;
+
+        traversePreorder([&eval, &nodes, &quos](size_t k, size_t idx) {
             size_t numBits = eval.getNumBits();
             size_t n = eval.getNumPoints();
 
@@ -258,18 +425,110 @@ protected:
             if(k == 0 && libff::bitreverse(idx, numBits) >= n)
                 return;
 
-            auto& quo = eval.tree[k][idx].quo;
-            if(simulate) {
-                Fr qOfS = libfqfft::evaluate_polynomial(quo.size(), quo, kpp.getTrapdoor());
-                tree[k][idx] = qOfS * G1::one();
-            } else {
-                tree[k][idx] = multiExp<G1>(
-                    kpp.g1si.begin(),
-                    kpp.g1si.begin() + static_cast<long>(quo.size()),
-                    quo.begin(),
-                    quo.end());
-            }
+            nodes.push_back(std::make_pair(k, idx));
+            quos.push_back(&eval.tree[k][idx].quo);
         });
+
+        commit(nodes, quos, simulate, grainSize);
+    }
+
+    void authenticateStreaming(const std::vector<Fr>& f, const AccumulatorTree& accs, bool simulate,
+        std::vector<Fr>& evals, size_t grainSize)
+    {
+        size_t n = accs.getNumPoints();
+        size_t numBits = accs.getNumBits();
+        size_t rootLevel = tree.size() - 1;
+
+        // level k keeps its remainders in rems[k % 2], which overwrites those of level k + 2
+        std::vector<Fr> rems[2], quoCoeffs;
+        std::vector<EvalPolys> levels[2];
+
+        for(size_t k = rootLevel + 1; k-- > 0; ) {
+            std::vector<EvalPolys>& parents = levels[(k + 1) % 2];
+            std::vector<EvalPolys>& polys = levels[k % 2];
+
+            // size this level's polynomials (see RootsOfUnityEvaluation::allocateCoeffs)
+            std::vector<std::pair<size_t, size_t>> nodes, sizes;
+            size_t numQuo = 0, numRem = 0;
+            for(size_t idx = 0; idx < tree[k].size(); idx++) {
+                // no need to compute quotient/remainder for the ith leaf if bitreverse(i) >= n
+                if(k == 0 && libff::bitreverse(idx, numBits) >= n)
+                    continue;
+
+                size_t a = k == rootLevel ? f.size() : parents[idx / arity].rem.size();
+                nodes.push_back(std::make_pair(k, idx));
+                sizes.push_back(RootsOfUnityEvaluation::getDivisionSizes(a,
+                    RootsOfUnityEvaluation::getAccumulator(accs, arity, k, idx)));
+                numQuo += sizes.back().first;
+                numRem += sizes.back().second;
+            }
+
+            quoCoeffs.resize(numQuo);
+            rems[k % 2].resize(numRem);
+            polys.assign(tree[k].size(), EvalPolys());
+            for(size_t j = 0, quoOffset = 0, remOffset = 0; j < nodes.size(); j++) {
+                EvalPolys& node = polys[nodes[j].second];
+                node.quo = PolySlice<Fr>(quoCoeffs, quoOffset, sizes[j].first);
+                node.rem = PolySlice<Fr>(rems[k % 2], remOffset, sizes[j].second);
+                quoOffset += sizes[j].first;
+                remOffset += sizes[j].second;
+            }
+
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic) if(nodes.size() > 1)
+#endif
+            for(size_t j = 0; j < nodes.size(); j++) {
+                size_t idx = nodes[j].second;
+                auto& acc = RootsOfUnityEvaluation::getAccumulator(accs, arity, k, idx);
+                if(k == rootLevel) {
+                    RootsOfUnityEvaluation::divide(f.data(), f.size(), acc, polys[idx]);
+                } else {
+                    auto& parentRem = parents[idx / arity].rem;
+                    RootsOfUnityEvaluation::divide(parentRem.data(), parentRem.size(), acc, polys[idx]);
+                }
+            }
+
+            std::vector<const PolySlice<Fr>*> quos;
+            for(auto& node : nodes) {
+                quos.push_back(&polys[node.second].quo);
+            }
+            commit(nodes, quos, simulate, grainSize);
+        }
+
+        // the leaves' remainders are the evaluations
+        evals.resize(n);
+        for(size_t i = 0; i < n; i++) {
+            auto& rem = levels[0][libff::bitreverse(i, numBits)].rem;
+            assertEqual(rem.size(), 1);
+            evals[i] = rem[0];
+        }
+    }
+
+    /**
+     * Commits to the quotients quos[j] of the nodes nodes[j] = (level, index).
+     */
+    void commit(const std::vector<std::pair<size_t, size_t>>& nodes, const std::vector<const PolySlice<Fr>*>& quos,
+        bool simulate, size_t grainSize)
+    {
+        if(simulate) {
+            // one exponentiation per node, after evaluating its quotient at the trapdoor
+            std::vector<size_t> sizes(nodes.size(), 1);
+            scheduleMultiExps(sizes, [this, &nodes, &quos](size_t j) {
+                auto& quo = *quos[j];
+                const Fr& s = kpp.getTrapdoor();
+                Fr qOfS = Fr::zero();
+                for(size_t i = quo.size(); i-- > 0; ) {
+                    qOfS = qOfS * s + quo[i];
+                }
+                tree[nodes[j].first][nodes[j].second] = g1Exp(qOfS);
+            }, grainSize);
+        } else {
+            // most quotients are small (e.g., the leaves), so we commit to all of them at once
+            std::vector<G1> comms = kpp.commitBatch(quos, grainSize);
+            for(size_t j = 0; j < nodes.size(); j++) {
+                tree[nodes[j].first][nodes[j].second] = comms[j];
+            }
+        }
     }
 };
 
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <type_traits>
+#include <vector>
+
+#include <gmp.h>
+
+#include <libff/algebra/scalar_multiplication/wnaf.hpp>
+
+#include <polycrypto/PolyCrypto.h>
+
+namespace libpolycrypto {
+
+/**
+ * A reduced basis {(a1, b1), (a2, b2)} for the lattice of all (a, b) with a + b\lambda = 0 mod r,
+ * computed with the extended Euclidean algorithm as in [GLV01]. Used to split a scalar k into
+ * k1 + k2\lambda with |k1|, |k2| about \sqrt{r}, so that k P = k1 P + k2 \phi(P) only needs half
+ * the doublings.
+ */
+class GlvBasis {
+protected:
+    mpz_t a1, b1, a2, b2;
+    mpz_t det;  // a1 b2 - a2 b1, which is +/- r
+
+public:
+    GlvBasis(const Fr& lambda);
+    ~GlvBasis();
+
+    GlvBasis(const GlvBasis&) = delete;
+    GlvBasis& operator=(const GlvBasis&) = delete;
+
+public:
+    /**
+     * Sets k1 and k2 (already initialized) such that k = k1 + k2\lambda mod r. They can be negative.
+     */
+    void decompose(const Fr& k, mpz_t k1, mpz_t k2) const;
+};
+
+/**
+ * An efficiently-computable endomorphism \phi of the group, such that \phi(P) = \lambda P.
+ * We only have one for BN curves: on G1, (x, y) -> (\beta x, y) where \beta is a cube root of
+ * unity in Fq (GLV), and, on G2, the untwist-Frobenius-twist map, which is multiplication by
+ * p mod r = 6u^2 (GLS). The latter needs alt_bn128's G2::mul_by_q(), so it is not available on BN128.
+ */
+template<class Group>
+struct Endomorphism {
+    static const bool Enabled = false;
+};
+
+#if defined(CURVE_BN128) || defined(CURVE_ALT_BN128)
+template<>
+struct Endomorphism<G1> {
+    static const bool Enabled = true;
+
+    static G1 apply(const G1& p);
+    static const Fr& getEigenvalue();   // \lambda
+    static const GlvBasis& getBasis();
+};
+#endif
+
+#if defined(CURVE_ALT_BN128)
+template<>
+struct Endomorphism<G2> {
+    static const bool Enabled = true;
+
+    static G2 apply(const G2& p);
+    static const Fr& getEigenvalue();   // \lambda
+    static const GlvBasis& getBasis();
+};
+#endif
+
+/**
+ * Throws std::runtime_error if an endomorphism's constants are wrong for this curve (e.g., \beta
+ * or \lambda is not a cube root of unity, or \phi(g) != \lambda g). Called by initialize(), so a bad
+ * constant fails loudly instead of silently corrupting every scalarMul().
+ */
+void checkEndomorphisms();
+
+/**
+ * The wNAF window used for the two half-size scalars in glvMul(): 2^{w-1} precomputed odd
+ * multiples per scalar, and about 128 / (w + 1) additions each.
+ */
+const size_t GlvWindowSize = 4;
+
+/**
+ * Computes k P as k1 P + k2 \phi(P), where k = k1 + k2\lambda is split with the given basis and
+ * phi(Q) = \lambda Q. The two half-size scalars are recoded in wNAF and interleaved (Straus), so
+ * they share the same ~128 doublings.
+ */
+template<class Group, class Endo>
+Group glvMul(const Fr& k, const Group& p, const Endo& phi, const GlvBasis& basis) {
+    typedef decltype(k.as_bigint()) BigInt;
+
+    if(p.is_zero() || k.is_zero())
+        return Group::zero();
+
+    mpz_t k1, k2;
+    mpz_init(k1);
+    mpz_init(k2);
+    basis.decompose(k, k1, k2);
+
+    bool neg1 = mpz_sgn(k1) < 0, neg2 = mpz_sgn(k2) < 0;
+    mpz_abs(k1, k1);
+    mpz_abs(k2, k2);
+    std::vector<long> naf1 = libff::find_wnaf(GlvWindowSize, BigInt(k1));
+    std::vector<long> naf2 = libff::find_wnaf(GlvWindowSize, BigInt(k2));
+    mpz_clear(k1);
+    mpz_clear(k2);
+
+    // odd multiples (2i+1) P of P and of \phi(P), with the signs of k1 and k2 folded in
+    const size_t tableSize = static_cast<size_t>(1) << (GlvWindowSize - 1);
+    std::vector<Group> table1(tableSize), table2(tableSize);
+    table1[0] = neg1 ? -p : p;
+    Group dbl = table1[0].dbl();
+    for(size_t i = 1; i < tableSize; i++) {
+        table1[i] = table1[i - 1] + dbl;
+    }
+    for(size_t i = 0; i < tableSize; i++) {
+        table2[i] = phi(table1[i]);
+        if(neg1 != neg2)
+            table2[i] = -table2[i];
+    }
+
+    Group result = Group::zero();
+    bool found = false;
+    for(size_t i = std::max(naf1.size(), naf2.size()); i > 0; i--) {
+        if(found)
+            result = result.dbl();
+
+        long d1 = i <= naf1.size() ? naf1[i - 1] : 0;
+        long d2 = i <= naf2.size() ? naf2[i - 1] : 0;
+        if(d1 != 0) {
+            found = true;
+            result = d1 > 0 ? result + table1[static_cast<size_t>(d1 / 2)] : result - table1[static_cast<size_t>(-d1 / 2)];
+        }
+        if(d2 != 0) {
+            found = true;
+            result = d2 > 0 ? result + table2[static_cast<size_t>(d2 / 2)] : result - table2[static_cast<size_t>(-d2 / 2)];
+        }
+    }
+
+    return result;
+}
+
+namespace internal {
+
+template<class Group>
+Group scalarMul(const Fr& k, const Group& p, std::true_type) {
+    return glvMul(k, p, &Endomorphism<Group>::apply, Endomorphism<Group>::getBasis());
+}
+
+template<class Group>
+Group scalarMul(const Fr& k, const Group& p, std::false_type) {
+    return libff::opt_window_wnaf_exp(p, k.as_bigint(), Fr::size_in_bits());
+}
+
+} // end of namespace internal
+
+/**
+ * Computes k P with the GLV/GLS method when the group has an endomorphism (see Endomorphism),
+ * or with wNAF otherwise. Both are faster than libff's k * P, which is double-and-add.
+ */
+template<class Group>
+Group scalarMul(const Fr& k, const Group& p) {
+    return internal::scalarMul(k, p, std::integral_constant<bool, Endomorphism<Group>::Enabled>());
+}
+
+/**
+ * The window size, in bits, of the process-wide tables used by g1Exp() and g2Exp(): they store
+ * d 2^{wj} g for every w-bit digit d and every window j, so k g takes ceil(|Fr| / w) mixed
+ * additions and no doublings. With w = 8, that is 32 additions and 8160 points per group.
+ */
+const size_t GeneratorWindowSize = 8;
+
+/**
+ * Returns k g, where g = G1::one(). The table is built the first time this is called.
+ */
+G1 g1Exp(const Fr& k);
+
+/**
+ * Returns k h, where h = G2::one(). The table is built the first time this is called.
+ */
+G2 g2Exp(const Fr& k);
+
+/**
+ * Returns k g for all k in ks, computed in parallel and normalized to affine with one batch
+ * inversion, so they are cheaper to add (e.g., in a multiexp) or serialize afterwards.
+ */
+std::vector<G1> g1ExpBatch(const std::vector<Fr>& ks);
+
+std::vector<G2> g2ExpBatch(const std::vector<Fr>& ks);
+
+} // end of namespace libpolycrypto
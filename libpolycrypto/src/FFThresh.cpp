@@ -4,6 +4,7 @@
 #include <polycrypto/Configuration.h>
 #include <polycrypto/FFThresh.h>
 #include <polycrypto/PolyOps.h>
+#include <polycrypto/ScalarMult.h>
 
 #include <xutils/Utils.h>
 
@@ -20,25 +21,20 @@ void generate_keys(size_t n, size_t k, G2& pk, vector<Fr>& sk, vector<G2>* pkSig
     size_t N = Utils::smallestPowerOfTwoAbove(n);
 
     // pk = g2^s = g2^p(0)
-    pk = p[0]  * G2::one();
+    pk = g2Exp(p[0]);
 
-    // sk[i] = p evaluated at w_N^i
-    poly_fft(p, N, sk);
-    // we only need the first n <= N roots of unity
-    sk.resize(n);
+    // sk[i] = p evaluated at w_N^i, for the first n <= N roots of unity only
+    fft_truncated(p, N, n, sk);
 
     if(pkSigners != nullptr) {
         // pkSigners[i] = g2^s_i
-        pkSigners->resize(n); 
-        for (size_t i = 0; i < n; i++) {
-            (*pkSigners)[i] = sk[i] * G2::one();
-        }
+        *pkSigners = g2ExpBatch(sk);
     }
 }
 
 G1 shareSign(const Fr& shareKey, const G1& msgHash) {
     // TODO: assuming message is really H(message)
-    return shareKey * msgHash;
+    return scalarMul(shareKey, msgHash);
 }
 
 G1 aggregate(const vector<G1>& sigShare, const vector<Fr>& coeffs) {
@@ -101,8 +97,10 @@ void descend_batch_trees(
     const vector<vector<G2>>& pkTree,
     const G1& H, size_t k, size_t index)
 {
-    // return if verifies correctly
-    if (ReducedPairing(sigShareTree[k][index], G2::one()) == ReducedPairing(H, pkTree[k][index])) return;
+    // return if verifies correctly, i.e., if e(sig, g2) e(H, pk)^{-1} = 1
+    // (only g2 is fixed here: every pk node is paired once, so it is prepared on the fly)
+    PreparedG2 pk(pkTree[k][index]);
+    if (MultiPairing({ sigShareTree[k][index], -H }, std::vector<const PreparedG2*>{ &preparedG2One(), &pk }) == GT::one()) return;
 
     // if on bottom row, set share to false
     if (k == 0) {
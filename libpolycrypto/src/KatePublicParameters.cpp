@@ -1,22 +1,296 @@
 #include <polycrypto/Configuration.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 
 #include <polycrypto/KatePublicParameters.h>
+#include <polycrypto/MappedFile.h>
+#include <polycrypto/PointCompression.h>
+
+#include <xutils/Utils.h>
+
+using libpolycrypto::MappedFile;
+using libpolycrypto::CompressedPoint;
+using libpolycrypto::compressPoints;
+using libpolycrypto::decompressPoints;
 
 namespace Dkg { 
 
-KatePublicParameters::KatePublicParameters(const std::string& trapFile, size_t maxQ, bool progress, bool verify) {
+namespace {
+
+/**
+ * Header of the binary public parameters file (see KatePublicParameters::fromBinary).
+ * All fields are in the machine's native byte order.
+ */
+struct BinaryHeader {
+    char magic[8];          // "PCKPP" followed by zeros
+    uint32_t version;       // BinaryFormatVersion
+    uint32_t flags;         // BinaryFlagCompressed or 0
+    uint64_t q;             // the file stores g^{s^i} for i \in [0, q]
+    uint32_t g1RecordSize;  // sizeof(G1) in the build that wrote the file, or G1CompressedSize
+    uint32_t g2RecordSize;  // sizeof(G2) in the build that wrote the file, or G2CompressedSize
+    uint64_t g1Checksum;    // checksum of the q+1 G1 records
+    uint64_t g2Checksum;    // checksum of the q+1 G2 records
+    unsigned char reserved[16];
+};
+
+static_assert(sizeof(BinaryHeader) == 64, "BinaryHeader should be 64 bytes");
+
+const char BinaryMagic[8] = { 'P', 'C', 'K', 'P', 'P', 0, 0, 0 };
+const uint32_t BinaryFormatVersion = 1;
+
+// Points are stored compressed (see PointCompression.h) rather than as raw libff points
+const uint32_t BinaryFlagCompressed = 1;
+
+/**
+ * 64-bit FNV-1a, except it consumes 8-byte words rather than bytes, so that
+ * hashing hundreds of MiBs of records does not take longer than reading them.
+ */
+class Checksum {
+private:
+    uint64_t h;
+
+public:
+    Checksum() : h(14695981039346656037ULL) {}
+
+public:
+    void update(const unsigned char * buf, size_t len) {
+        size_t i = 0;
+        for(; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+            uint64_t w;
+            memcpy(&w, buf + i, sizeof(w));
+            mix(w);
+        }
+
+        for(; i < len; i++) {
+            mix(buf[i]);
+        }
+    }
+
+    uint64_t digest() const { return h; }
+
+private:
+    void mix(uint64_t w) {
+        h ^= w;
+        h *= 1099511628211ULL;
+    }
+};
+
+/**
+ * Checksums 'count' records of size 'recSize', one record at a time, just like writeRecords() does.
+ */
+uint64_t checksumRecords(const unsigned char * buf, size_t count, size_t recSize) {
+    Checksum c;
+    for(size_t i = 0; i < count; i++) {
+        c.update(buf + i * recSize, recSize);
+    }
+    return c.digest();
+}
+
+template<class Group>
+size_t recordSize(bool compressed) {
+    return compressed ? CompressedPoint<Group>::Size : sizeof(Group);
+}
+
+/**
+ * Writes the points either compressed or in affine form as raw records, and returns their checksum.
+ */
+template<class Group>
+uint64_t writeRecords(std::ostream& out, const std::vector<Group>& points, bool compressed) {
+    Checksum c;
+    if(compressed) {
+        std::vector<unsigned char> bytes = compressPoints(points);
+        for(size_t i = 0; i < points.size(); i++) {
+            c.update(bytes.data() + i * CompressedPoint<Group>::Size, CompressedPoint<Group>::Size);
+        }
+        out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return c.digest();
+    }
+
+    for(const Group& p : points) {
+        Group rec(p);
+        rec.to_affine_coordinates();
+
+        const unsigned char * bytes = reinterpret_cast<const unsigned char *>(&rec);
+        c.update(bytes, sizeof(Group));
+        out.write(reinterpret_cast<const char *>(bytes), static_cast<std::streamsize>(sizeof(Group)));
+    }
+    return c.digest();
+}
+
+/**
+ * Reads points.size() records into points, either by decompressing them or by copying them.
+ */
+template<class Group>
+void readRecords(const unsigned char * buf, std::vector<Group>& points, bool compressed) {
+    if(compressed) {
+        // NOTE: The parameters are trusted input, so we skip the subgroup check, which would cost a
+        // scalar multiplication for every G2 point. validatePowers() checks them, all at once.
+        decompressPoints(buf, points, false);
+    } else {
+        // NOTE: libff points are plain arrays of limbs, so they can be copied as bytes
+        memcpy(static_cast<void *>(points.data()), buf, points.size() * sizeof(Group));
+    }
+}
+
+/**
+ * Counts the lines in a text file.
+ */
+size_t countLines(const std::string& file) {
+    MappedFile mf(file);
+    mf.adviseSequential(0, mf.size());
+
+    const unsigned char * p = mf.data();
+    const unsigned char * end = p + mf.size();
+    size_t numLines = 0;
+    while(p < end) {
+        p = static_cast<const unsigned char *>(memchr(p, '\n', static_cast<size_t>(end - p)));
+        if(p == nullptr)
+            break;
+
+        numLines++;
+        p++;
+    }
+
+    return numLines;
+}
+
+/**
+ * Computes g1^{s^i} and g2^{s^i} with libff's fixed-base windowed exponentiation, which
+ * precomputes (g^{2^{wj}})^k for every window j and every k < 2^w, so that every power
+ * only costs about |Fr|/w additions.
+ */
+class PowersGenerator {
+private:
+    // Caps the window size libff picks for large q, since the tables have 2^w entries per window
+    // (2^12 entries per window for G1 and G2 already take ~25 MiB)
+    static const size_t MaxWindow = 12;
+
+    size_t scalarSize;
+    size_t g1Window, g2Window;
+    libff::window_table<G1> g1Table;
+    libff::window_table<G2> g2Table;
+
+public:
+    PowersGenerator(size_t numExps)
+        : scalarSize(Fr::size_in_bits()),
+          g1Window(std::min(libff::get_exp_window_size<G1>(numExps), static_cast<size_t>(MaxWindow))),
+          g2Window(std::min(libff::get_exp_window_size<G2>(numExps), static_cast<size_t>(MaxWindow))),
+          g1Table(libff::get_window_table(scalarSize, g1Window, G1::one())),
+          g2Table(libff::get_window_table(scalarSize, g2Window, G2::one()))
+    {}
+
+public:
+    /**
+     * Sets g1[j] = g1^{s^{start + j}} and g2[j] = g2^{s^{start + j}} for all j < g1.size(),
+     * and normalizes them to affine.
+     */
+    void compute(const Fr& s, size_t start, std::vector<G1>& g1, std::vector<G2>& g2) const {
+        assertEqual(g1.size(), g2.size());
+        size_t count = g1.size();
+
+#ifdef USE_MULTITHREADING
+        size_t numThreads = libpolycrypto::getNumCores();
+#else
+        size_t numThreads = 1;
+#endif
+        // every thread gets a contiguous range, so it only computes s^i once
+        size_t perThread = (count + numThreads - 1) / numThreads;
+
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for
+#endif
+        for(size_t t = 0; t < numThreads; t++) {
+            size_t begin = t * perThread;
+            size_t end = std::min(begin + perThread, count);
+
+            Fr si = s ^ (start + begin);
+            for(size_t j = begin; j < end; j++) {
+                g1[j] = libff::windowed_exp(scalarSize, g1Window, g1Table, si);
+                g2[j] = libff::windowed_exp(scalarSize, g2Window, g2Table, si);
+                si *= s;
+            }
+        }
+
+        // one field inversion for all points, rather than one per point when they are serialized
+        libff::batch_to_special(g1);
+        libff::batch_to_special(g2);
+    }
+};
+
+/**
+ * Writes g1^{s^i} and g2^{s^i} for i \in [startIncl, endExcl) to outFile, computing them
+ * one block at a time.
+ */
+void writePowers(const PowersGenerator& gen, size_t startIncl, size_t endExcl, const Fr& s, const std::string& outFile, bool progress) {
+    ofstream fout(outFile);
+
+    if(fout.fail()) {
+        throw std::runtime_error("Could not open public parameters file for writing");
+    }
+
+    const size_t blockSize = 1u << 14;
+    std::vector<G1> g1;
+    std::vector<G2> g2;
+    int prevPct = -1;
+    for(size_t i = startIncl; i < endExcl; i += blockSize) {
+        size_t count = std::min(blockSize, endExcl - i);
+        g1.resize(count);
+        g2.resize(count);
+        gen.compute(s, i, g1, g2);
+
+        for(size_t j = 0; j < count; j++) {
+            fout << g1[j] << "\n";
+            fout << g2[j] << "\n";
+        }
+
+        if(progress) {
+            int pct = static_cast<int>(static_cast<double>(i + count - startIncl)/static_cast<double>(endExcl-startIncl) * 100.0);
+            if(pct > prevPct) {
+                loginfo << pct << "% ... (i = " << i + count - 1 << " out of " << endExcl-1 << ")" << endl;
+                prevPct = pct;
+
+                fout << std::flush;
+            }
+        }
+    }
+
+    fout.close();
+}
+
+} // end of anonymous namespace
+
+KatePublicParameters::KatePublicParameters(const Fr& s, size_t q)
+    : q(q), s(s)
+{
+    resize(q);
+
+    loginfo << "Generating q-SDH params, q = " << q << endl;
+    PowersGenerator gen(q + 1);
+    gen.compute(s, 0, g1si, g2si);
+}
+
+void KatePublicParameters::readTrapdoor(const std::string& trapFile, Fr& s, size_t& q) {
     ifstream tin(trapFile);
     if(tin.fail()) {
         throw std::runtime_error("Could not open trapdoor file for reading");
     }
 
+    tin >> s;
+    tin >> q;
+
+    if(tin.fail() || tin.bad()) {
+        throw std::runtime_error("Error reading full trapdoor file");
+    }
+}
+
+KatePublicParameters::KatePublicParameters(const std::string& trapFile, size_t maxQ, bool progress, bool verify) {
     loginfo << "Reading back q-PKE parameters... (verify = " << verify << ")" << endl;
 
-    tin >> s;
-    tin >> q;       // we read the q before so as to preallocate the std::vectors
-    libff::consume_OUTPUT_NEWLINE(tin);
+    // we read the q before so as to preallocate the std::vectors
+    readTrapdoor(trapFile, s, q);
 
     loginfo << "available q = " << q << ", s = " << s << endl;
 
@@ -25,101 +299,301 @@ KatePublicParameters::KatePublicParameters(const std::string& trapFile, size_t m
         throw std::runtime_error("maxQ needs to be <= q");
     }
 
-    if(tin.fail() || tin.bad()) {
-        throw std::runtime_error("Error reading full trapdoor file");
-    }
-    
-    tin.close();
-
     // if maxQ is set to the default 0 value, read all q public params from the file
     q = maxQ == 0 ? q : maxQ;
     loginfo << "wanted q = " << maxQ << endl;
     resize(q);
         
+    // Find the chunk files and how many parameters each one stores, so that every chunk
+    // can be read independently, straight into its own range of g1si and g2si
+    auto chunkFile = [&trapFile](size_t c) {
+        return trapFile + "-" + std::to_string(c);
+    };
+    std::vector<size_t> chunkStart, chunkCount;
+    size_t numParams = 0;
+    while(numParams <= q) {
+        std::string inFile = chunkFile(chunkStart.size());
+
+        // every parameter takes two lines: g1^{s^i} and then g2^{s^i}
+        size_t count = countLines(inFile) / 2;
+        logdbg << "'" << inFile << "' has " << count << " params" << endl;
+        if(count == 0) {
+            throw std::runtime_error("Public parameters file '" + inFile + "' is empty");
+        }
+
+        chunkStart.push_back(numParams);
+        chunkCount.push_back(std::min(count, q + 1 - numParams));
+        numParams += chunkCount.back();
+    }
+
+    size_t numChunks = chunkStart.size();
+    loginfo << "Reading " << q + 1 << " params from " << numChunks << " files..." << endl;
+
+    // NOTE: exceptions cannot leave an OpenMP parallel region, so we record the first one
+    bool failed = false;
+    std::string error;
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(size_t c = 0; c < numChunks; c++) {
+        try {
+            readChunk(chunkFile(c), chunkStart[c], chunkCount[c], progress, verify);
+        } catch(const std::exception& e) {
+#ifdef USE_MULTITHREADING
+#pragma omp critical
+#endif
+            {
+                if(!failed) {
+                    failed = true;
+                    error = "Failed reading '" + chunkFile(c) + "': " + e.what();
+                }
+            }
+        }
+    }
+
+    if(failed) {
+        logerror << error << endl;
+        throw std::runtime_error(error);
+    }
+}
+
+void KatePublicParameters::readChunk(const std::string& inFile, size_t start, size_t count, bool progress, bool verify) {
+    ifstream fin(inFile);
+    if(fin.fail()) {
+        throw std::runtime_error("Could not open public parameters file for reading");
+    }
+
     G1 g1 = G1::one();
     G2 g2 = G2::one();
-    Fr si = Fr::one();  // will store s^i
+    Fr si = s ^ start;  // will store s^i
 
-    size_t i = 0;
-    int iter = 0;
-    G1 tmpG1si;
-    G2 tmpG2si;
-    int prevPct = -1;
-    while(i <= q) {
-        std::string inFile = trapFile + "-" + std::to_string(iter);
-        loginfo << q - i << " params left to read, looking at " << inFile << " ..." << endl;
-        ifstream fin(inFile);
+    // when only showing progress, check about 100 parameters across all chunks
+    size_t checkEvery = std::max<size_t>((q + 1) / 100, 1);
+
+    for(size_t i = start; i < start + count; i++) {
+        // read g1^{s^i}
+        fin >> g1si[i];
+        libff::consume_OUTPUT_NEWLINE(fin);
+
+        // read g2^{s^i}
+        fin >> g2si[i];
+        libff::consume_OUTPUT_NEWLINE(fin);
 
         if(fin.fail()) {
-            throw std::runtime_error("Could not open public parameters file for reading");
+            throw std::runtime_error("Could not read parameter " + std::to_string(i) + " from '" + inFile + "'");
         }
-        
-        size_t line = 0;
-        while(i <= q) {
-            line++;
-
-            // read g1^{s^i}
-            fin >> tmpG1si;
-            if(fin.eof()) {
-                logdbg << "Reached end of '" << inFile << "' at line " << line << endl;
-                break;
+
+        // Fully verify the parameters if verify is true, or only occasionally if progress is true
+        if(verify || (progress && i % checkEvery == 0)) {
+            if(g1si[i] != si*g1 || g2si[i] != si*g2) {
+                throw std::runtime_error("Parameter " + std::to_string(i) + " in '" + inFile + "' does not match the trapdoor");
             }
+        }
 
-            g1si[i] = tmpG1si;
-            libff::consume_OUTPUT_NEWLINE(fin);
+        si = si * s;
+    }
 
-            // read g2^{s^i}
-            fin >> tmpG2si;
-            if(fin.eof()) {
-                logdbg << "Reached end of '" << inFile << "' at line " << line << endl;
-                break;
-            }
+    if(progress) {
+        logdbg << "Read params [" << start << ", " << start + count << ") from '" << inFile << "'" << endl;
+    }
+}
 
-            g2si[i] = tmpG2si;
-            libff::consume_OUTPUT_NEWLINE(fin);
+KatePublicParameters KatePublicParameters::fromBinary(const std::string& binFile, const std::string& trapFile, size_t maxQ, bool verifyChecksum) {
+    return readBinary(binFile, trapFile, maxQ, verifyChecksum, nullptr);
+}
 
-            // Check what we're reading against trapdoors
+KatePublicParameters KatePublicParameters::fromBinaryWithG2Subset(const std::string& binFile, const std::vector<size_t>& g2Indices,
+    const std::string& trapFile, size_t maxQ, bool verifyChecksum)
+{
+    return readBinary(binFile, trapFile, maxQ, verifyChecksum, &g2Indices);
+}
 
-            //logtrace << g1si[i] << endl;
-            //logtrace << si*g1 << endl << endl;
-            //logtrace << g2si[i] << endl;
-            //logtrace << si*g2 << endl << endl;
+std::vector<size_t> KatePublicParameters::getAmtG2Indices(size_t q) {
+    std::vector<size_t> indices;
+    indices.push_back(0);
+    for(size_t i = 1; i <= q; i *= 2) {
+        indices.push_back(i);
+    }
+    return indices;
+}
 
-            // Fully verify the parameters, if verify is true
-            if(verify) {
-                testAssertEqual(g1si[i], si*g1);
-                testAssertEqual(g2si[i], si*g2);
-            }
-        
-            if(progress) {
-                //int pct = static_cast<int>(static_cast<double>(c)/static_cast<double>(endExcl-startIncl) * 10000.0);
-                int pct = static_cast<int>(static_cast<double>(i)/static_cast<double>(q+1) * 100.0);
-                if(pct > prevPct) {
-                    logdbg << pct << "% ... (i = " << i << " out of " << q+1 << ")" << endl;
-                    prevPct = pct;
-                    
-                    // Occasionally check the parameters
-                    testAssertEqual(g1si[i], si*g1);
-                    testAssertEqual(g2si[i], si*g2);
-                }
+KatePublicParameters KatePublicParameters::readBinary(const std::string& binFile, const std::string& trapFile,
+    size_t maxQ, bool verifyChecksum, const std::vector<size_t>* g2Indices)
+{
+    KatePublicParameters pp;
+
+    if(!trapFile.empty()) {
+        size_t trapQ;
+        readTrapdoor(trapFile, pp.s, trapQ);
+    }
+
+    MappedFile mf(binFile);
+    loginfo << "Reading binary q-PKE parameters from '" << binFile << "' (" << Utils::humanizeBytes(mf.size()) << ")" << endl;
+
+    BinaryHeader hdr;
+    if(mf.size() < sizeof(hdr)) {
+        throw std::runtime_error("Binary public parameters file is too small to hold a header");
+    }
+    memcpy(&hdr, mf.data(), sizeof(hdr));
+
+    if(memcmp(hdr.magic, BinaryMagic, sizeof(BinaryMagic)) != 0) {
+        throw std::runtime_error("Not a binary public parameters file (bad magic)");
+    }
+    if(hdr.version != BinaryFormatVersion) {
+        logerror << "Binary public parameters file has version " << hdr.version << ", but we only read version " << BinaryFormatVersion << endl;
+        throw std::runtime_error("Unsupported binary public parameters version");
+    }
+    if((hdr.flags & ~BinaryFlagCompressed) != 0) {
+        throw std::runtime_error("Unsupported flags in binary public parameters header");
+    }
+
+    bool compressed = (hdr.flags & BinaryFlagCompressed) != 0;
+    size_t g1RecSize = recordSize<G1>(compressed), g2RecSize = recordSize<G2>(compressed);
+    if(hdr.g1RecordSize != g1RecSize || hdr.g2RecordSize != g2RecSize) {
+        logerror << "File has G1 and G2 records of " << hdr.g1RecordSize << " and " << hdr.g2RecordSize
+                 << " bytes, but this build expects " << g1RecSize << " and " << g2RecSize << " bytes" << endl;
+        throw std::runtime_error("Binary public parameters were written by a build with a different curve or point layout");
+    }
+
+    size_t fileQ = static_cast<size_t>(hdr.q);
+    size_t numRecs = fileQ + 1;
+    size_t g1Bytes = numRecs * g1RecSize, g2Bytes = numRecs * g2RecSize;
+    if(mf.size() != sizeof(hdr) + g1Bytes + g2Bytes) {
+        throw std::runtime_error("Binary public parameters file has the wrong size (truncated?)");
+    }
+
+    if(maxQ > 0 && maxQ > fileQ) {
+        logerror << "You asked to read " << maxQ << " public parameters, but there are only " << fileQ << " in '" << binFile << "'" << endl;
+        throw std::runtime_error("maxQ needs to be <= q");
+    }
+
+    const unsigned char * g1Begin = mf.data() + sizeof(hdr);
+    const unsigned char * g2Begin = g1Begin + g1Bytes;
+
+    if(verifyChecksum) {
+        mf.adviseSequential(sizeof(hdr), g1Bytes + g2Bytes);
+
+        if(checksumRecords(g1Begin, numRecs, g1RecSize) != hdr.g1Checksum) {
+            throw std::runtime_error("Checksum mismatch for the G1 public parameters");
+        }
+        if(g2Indices == nullptr && checksumRecords(g2Begin, numRecs, g2RecSize) != hdr.g2Checksum) {
+            throw std::runtime_error("Checksum mismatch for the G2 public parameters");
+        }
+    }
+
+    pp.q = maxQ == 0 ? fileQ : maxQ;
+    pp.g1si.resize(pp.q + 1);
+
+    mf.adviseSequential(sizeof(hdr), (pp.q + 1) * g1RecSize);
+    readRecords(g1Begin, pp.g1si, compressed);
+
+    if(g2Indices == nullptr) {
+        pp.g2si.resize(pp.q + 1);
+        mf.adviseSequential(sizeof(hdr) + g1Bytes, (pp.q + 1) * g2RecSize);
+        readRecords(g2Begin, pp.g2si, compressed);
+    } else {
+        // the records have a fixed size, so we can go straight to the ones we need
+        for(size_t i : *g2Indices) {
+            if(i > pp.q) {
+                throw std::runtime_error("Asked for g2^{s^" + std::to_string(i) + "}, but q = " + std::to_string(pp.q));
             }
 
-            si = si * s;
-            i++;
+            std::vector<G2> rec(1);
+            readRecords(g2Begin + i * g2RecSize, rec, compressed);
+
+            if(verifyChecksum && ReducedPairing(pp.g1si[i], G2::one()) != ReducedPairing(G1::one(), rec[0])) {
+                throw std::runtime_error("g2^{s^" + std::to_string(i) + "} does not match g1^{s^" + std::to_string(i) + "}");
+            }
 
+            pp.g2Subset[i] = rec[0];
         }
+    }
 
-        fin.close();
-        iter++; // move to the next file
+    // cheap sanity check that the records were interpreted correctly
+    if(pp.g1si[0] != G1::one() || (pp.hasG2si(0) && pp.getG2si(0) != G2::one())) {
+        throw std::runtime_error("Binary public parameters do not start with the group generators");
     }
 
-    if(i < q) {
-        throw std::runtime_error("Did not read all parameters.");
+    return pp;
+}
+
+void KatePublicParameters::writeBinary(const std::string& binFile, bool compressed) const {
+    assertEqual(g1si.size(), q + 1);
+    assertEqual(g2si.size(), q + 1);
+
+    ofstream fout(binFile, std::ios::binary | std::ios::trunc);
+    if(fout.fail()) {
+        throw std::runtime_error("Could not open binary public parameters file for writing");
     }
 
-    if(i != q+1) {
-        throw std::runtime_error("Expected to read exactly q parameters.");
+    BinaryHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, BinaryMagic, sizeof(BinaryMagic));
+    hdr.version = BinaryFormatVersion;
+    hdr.flags = compressed ? BinaryFlagCompressed : 0;
+    hdr.q = static_cast<uint64_t>(q);
+    hdr.g1RecordSize = static_cast<uint32_t>(recordSize<G1>(compressed));
+    hdr.g2RecordSize = static_cast<uint32_t>(recordSize<G2>(compressed));
+
+    // write the header now to reserve its space and rewrite it once we know the checksums
+    fout.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+    hdr.g1Checksum = writeRecords(fout, g1si, compressed);
+    hdr.g2Checksum = writeRecords(fout, g2si, compressed);
+
+    fout.seekp(0);
+    fout.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+
+    if(fout.fail() || fout.bad()) {
+        throw std::runtime_error("Error writing binary public parameters file");
     }
+
+    fout.close();
+}
+
+bool KatePublicParameters::validatePowers() const {
+    if(g1si.size() != q + 1 || g2si.size() != q + 1) {
+        logerror << "Expected " << q + 1 << " parameters, got " << g1si.size() << " in G1 and " << g2si.size() << " in G2" << endl;
+        return false;
+    }
+
+    if(g1si[0] != G1::one() || g2si[0] != G2::one()) {
+        logerror << "g1si[0] and g2si[0] are not the generators" << endl;
+        return false;
+    }
+
+    if(q == 0) {
+        return true;
+    }
+
+    if(g1si[1].is_zero() || g1si[1] == G1::one()) {
+        logerror << "s is either 0 or 1" << endl;
+        return false;
+    }
+
+    // g1^{s^{i+1}} = (g1^{s^i})^s, for all i < q
+    std::vector<Fr> r = libpolycrypto::random_field_elems(q);
+    G1 lhsBase = multiExp<G1>(g1si.cbegin() + 1, g1si.cend(), r.cbegin(), r.cend());
+    G1 rhsBase = multiExp<G1>(g1si.cbegin(), g1si.cend() - 1, r.cbegin(), r.cend());
+    if(ReducedPairing(lhsBase, G2::one()) != ReducedPairing(rhsBase, g2si[1])) {
+        logerror << "The G1 parameters are not consecutive powers of s" << endl;
+        return false;
+    }
+
+    // g2^{s^i} has the same exponent as g1^{s^i}, for all i <= q
+    r = libpolycrypto::random_field_elems(q + 1);
+    G1 g1Comb = multiExp<G1>(g1si, r);
+    G2 g2Comb = multiExp<G2>(g2si, r);
+    if(!(G1::order() * g1Comb).is_zero() || !(G2::order() * g2Comb).is_zero()) {
+        logerror << "Some of the parameters are not in G1 or in G2" << endl;
+        return false;
+    }
+
+    if(ReducedPairing(g1Comb, G2::one()) != ReducedPairing(G1::one(), g2Comb)) {
+        logerror << "The G2 parameters do not match the G1 parameters" << endl;
+        return false;
+    }
+
+    return true;
 }
 
 Fr KatePublicParameters::generateTrapdoor(size_t q, const std::string& outFile)
@@ -152,41 +626,24 @@ void KatePublicParameters::generate(size_t startIncl, size_t endExcl, const Fr&
         return;
     }
 
-    ofstream fout(outFile);
-
-    if(fout.fail()) {
-        throw std::runtime_error("Could not open public parameters file for writing");
-    }
-
-    //logdbg << "i \\in [" << startIncl << ", " << endExcl << "), s = " << s << endl;
-
-    // generate q-PKE powers and write to file
-    Fr si = s ^ startIncl;
-    int prevPct = -1;
-    size_t c = 0;
-    for (size_t i = startIncl; i < endExcl; i++) {
-        G1 g1si = si * G1::one();
-        G2 g2si = si * G2::one();
+    PowersGenerator gen(endExcl - startIncl);
+    writePowers(gen, startIncl, endExcl, s, outFile, progress);
+}
 
-        fout << g1si << "\n";
-        fout << g2si << "\n";
-    
-        si *= s;
+void KatePublicParameters::generateChunks(const Fr& s, size_t q, const std::string& trapFile, size_t numChunks, bool progress)
+{
+    numChunks = std::max<size_t>(std::min(numChunks, q + 1), 1);
+    size_t chunkSize = (q + 1) / numChunks;
 
-        if(progress) {
-            int pct = static_cast<int>(static_cast<double>(c)/static_cast<double>(endExcl-startIncl) * 100.0);
-            if(pct > prevPct) {
-                loginfo << pct << "% ... (i = " << i << " out of " << endExcl-1 << ")" << endl;
-                prevPct = pct;
-                
-                fout << std::flush;
-            }
-        }
+    PowersGenerator gen(q + 1);
+    for(size_t c = 0; c < numChunks; c++) {
+        size_t start = c * chunkSize;
+        size_t end = c < numChunks - 1 ? (c + 1) * chunkSize : q + 1;
+        std::string outFile = trapFile + "-" + std::to_string(c);
 
-        c++;
+        loginfo << "Generating [" << start << ", " << end << ") in '" << outFile << "' ..." << endl;
+        writePowers(gen, start, end, s, outFile, progress);
     }
-    
-    fout.close();
 }
 
 }
@@ -4,6 +4,7 @@
 #include <polycrypto/PolyOps.h>
 #include <polycrypto/RootsOfUnityEval.h>
 
+#include <algorithm>
 #include <vector>
 #include <cmath>
 #include <iostream>
@@ -66,9 +67,9 @@ void lagrange_coefficients(std::vector<Fr>& lagr, const std::vector<Fr>& allOmeg
     std::vector<Fr> Ndiff;
     poly_differentiate(Num, Ndiff);
 
-    // D[i] = D_i = Num'(x_i), so we evaluate Num' at allOmegas and then return the values at someOmegas
+    // D[i] = D_i = Num'(x_i), so we evaluate Num' at allOmegas up to the last one in T and then return the values at someOmegas
     std::vector<Fr> D;
-    poly_fft(Ndiff, N, D);
+    fft_truncated(Ndiff, N, T.empty() ? 0 : *std::max_element(T.begin(), T.end()) + 1, D);
 
     // L[i] = L_i(0) = N_i(0) / D_i
     lagr.resize(T.size());
@@ -87,6 +88,72 @@ void lagrange_coefficients(std::vector<Fr>& lagr, const std::vector<Fr>& allOmeg
     return lagrange_coefficients(lagr, allOmegas, someOmegas, T);
 }
 
+void interpolate_at_roots_of_unity(std::vector<Fr>& f, const std::vector<Fr>& allOmegas, const std::vector<size_t>& T, const std::vector<Fr>& evals) {
+    size_t N = allOmegas.size();
+    size_t k = T.size();
+    assertTrue(Utils::isPowerOfTwo(N));
+
+    if(evals.size() != k) {
+        throw std::runtime_error("Need exactly one evaluation per point");
+    }
+    if(k > N) {
+        throw std::runtime_error("Cannot have more than N distinct Nth roots of unity");
+    }
+
+    f.clear();
+    if(k == 0)
+        return;
+
+    // when all the Nth roots of unity are given in order, this is just an inverse FFT
+    bool allInOrder = (k == N);
+    for(size_t i = 0; allInOrder && i < k; i++) {
+        allInOrder = (T[i] == i);
+    }
+    if(allInOrder) {
+        ifft(evals, f);
+        return;
+    }
+
+    std::vector<Fr> someOmegas;
+    for(size_t i : T) {
+        assertStrictlyLessThan(i, N);
+        someOmegas.push_back(allOmegas[i]);
+    }
+
+    // D[i] = Num'(w_N^i), evaluated at all w_N^i up to the last one in T (as in lagrange_coefficients)
+    std::vector<Fr> Num = poly_from_roots(someOmegas), Ndiff, D;
+    poly_differentiate(Num, Ndiff);
+    fft_truncated(Ndiff, N, *std::max_element(T.begin(), T.end()) + 1, D);
+
+    // E(x) = \sum_{i\in T} c_i w_N^{-i} x^{N-i}, so g_j = E(w_N^j) for j = 0, ..., k-1
+    std::vector<Fr> E(N, Fr::zero()), g;
+    for(size_t i = 0; i < k; i++) {
+        if(D[T[i]] == Fr::zero()) {
+            throw std::runtime_error("The evaluation points must be distinct");
+        }
+
+        size_t j = (N - T[i]) % N;
+        E[j] += evals[i] * D[T[i]].inverse() * allOmegas[j];
+    }
+    fft_truncated(E, N, k, g);
+
+    // f = -(Num * g mod x^k), multiplied via FFTs of size 2k
+    size_t M = Utils::smallestPowerOfTwoAbove(2*k - 1);
+    Num.resize(k);
+    std::vector<Fr> numVals, gVals;
+    fft(Num, M, numVals);
+    fft(g, M, gVals);
+    for(size_t i = 0; i < M; i++) {
+        numVals[i] *= gVals[i];
+    }
+    ifft(numVals, f);
+
+    f.resize(k);
+    for(auto& c : f) {
+        c = -c;
+    }
+}
+
 void lagrange_coefficients_naive(std::vector<Fr>& L, const std::vector<Fr>& allOmegas, const std::vector<Fr>& someOmegas, const std::vector<size_t>& T) {
     size_t N = allOmegas.size();
     assertTrue(Utils::isPowerOfTwo(N));
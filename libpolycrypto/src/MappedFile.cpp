@@ -0,0 +1,64 @@
+#include <polycrypto/Configuration.h>
+
+#include <polycrypto/MappedFile.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace libpolycrypto {
+
+MappedFile::MappedFile(const std::string& file)
+    : file(file), buf(nullptr), len(0)
+{
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if(fd < 0) {
+        throw std::runtime_error("Could not open '" + file + "' for mapping");
+    }
+
+    struct stat st;
+    if(::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not stat '" + file + "'");
+    }
+
+    len = static_cast<size_t>(st.st_size);
+    if(len > 0) {
+        void * addr = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(addr == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Could not mmap '" + file + "'");
+        }
+        buf = static_cast<const unsigned char *>(addr);
+    }
+
+    // NOTE: the mapping stays valid after the file descriptor is closed
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if(buf != nullptr) {
+        ::munmap(const_cast<unsigned char *>(buf), len);
+    }
+}
+
+void MappedFile::adviseSequential(size_t offset, size_t n) const {
+    if(buf == nullptr || offset >= len)
+        return;
+
+    // madvise() wants a page-aligned start address
+    size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t start = offset - offset % pageSize;
+    size_t end = std::min(offset + n, len);
+
+    // NOTE: these are just hints, so failures are not errors
+    unsigned char * addr = const_cast<unsigned char *>(buf) + start;
+    (void)::madvise(addr, end - start, MADV_SEQUENTIAL);
+    (void)::madvise(addr, end - start, MADV_WILLNEED);
+}
+
+} // end of namespace libpolycrypto
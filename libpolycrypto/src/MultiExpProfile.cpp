@@ -0,0 +1,215 @@
+#include <polycrypto/Configuration.h>
+
+#include <polycrypto/MultiExpProfile.h>
+#include <polycrypto/Pippenger.h>
+
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include <xutils/Log.h>
+
+#ifdef USE_MULTITHREADING
+# include <omp.h>
+#endif
+
+using namespace std;
+
+namespace libpolycrypto {
+
+namespace {
+
+const size_t Never = std::numeric_limits<size_t>::max();
+
+// in the file, a method that is never used has a threshold of 0
+size_t fromFile(size_t th) { return th == 0 ? Never : th; }
+size_t toFile(size_t th) { return th == Never ? 0 : th; }
+
+enum MultiExpMethod { Naive = 0, BosCoster, BDLO12, Pippenger, NumMethods };
+
+const char * methodName(int m) {
+    switch(m) {
+    case Naive:     return "naive";
+    case BosCoster: return "Bos-Coster";
+    case BDLO12:    return "BDLO12";
+    case Pippenger: return "Pippenger";
+    default:        return "unknown";
+    }
+}
+
+template<class Group>
+void runMethod(int m, const vector<Group>& bases, const vector<Fr>& exps, size_t numThreads) {
+    switch(m) {
+    case Naive:
+        libff::multi_exp<Group, Fr, libff::multi_exp_method_naive>(bases.cbegin(), bases.cend(), exps.cbegin(), exps.cend(), 1);
+        break;
+    case BosCoster:
+        libff::multi_exp<Group, Fr, libff::multi_exp_method_bos_coster>(bases.cbegin(), bases.cend(), exps.cbegin(), exps.cend(), 1);
+        break;
+    case BDLO12:
+        libff::multi_exp<Group, Fr, libff::multi_exp_method_BDLO12>(bases.cbegin(), bases.cend(), exps.cbegin(), exps.cend(), 1);
+        break;
+    case Pippenger:
+        pippengerMultiExp<Group, Fr>(bases.cbegin(), bases.cend(), exps.cbegin(), exps.cend(), numThreads);
+        break;
+    default:
+        throw std::runtime_error("Unknown multiexp method");
+    }
+}
+
+/**
+ * Returns the average time of the method in microseconds, over enough runs to take minMillis.
+ */
+template<class Group>
+double timeMethod(int m, const vector<Group>& bases, const vector<Fr>& exps, size_t numThreads, size_t minMillis) {
+    auto start = chrono::steady_clock::now();
+    size_t runs = 0;
+    double elapsed = 0;
+    do {
+        runMethod<Group>(m, bases, exps, numThreads);
+        runs++;
+        elapsed = static_cast<double>(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count());
+    } while(elapsed < static_cast<double>(minMillis) * 1000.0);
+
+    return elapsed / static_cast<double>(runs);
+}
+
+template<class Group>
+const char * groupName();
+
+template<>
+const char * groupName<G1>() { return "G1"; }
+
+template<>
+const char * groupName<G2>() { return "G2"; }
+
+} // end of anonymous namespace
+
+std::vector<MultiExpProfileEntry> readMultiExpProfile(const std::string& file) {
+    ifstream fin(file);
+    if(fin.fail()) {
+        throw std::runtime_error("Could not open multiexp profile '" + file + "' for reading");
+    }
+
+    std::vector<MultiExpProfileEntry> entries;
+    std::string line;
+    while(std::getline(fin, line)) {
+        if(line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream ss(line);
+        MultiExpProfileEntry e;
+        ss >> e.group >> e.numThreads >> e.thresholds.bosCoster >> e.thresholds.bdlo12 >> e.thresholds.pippenger;
+        if(ss.fail() || (e.group != "G1" && e.group != "G2")) {
+            throw std::runtime_error("Malformed line in multiexp profile '" + file + "': " + line);
+        }
+
+        e.thresholds.bosCoster = fromFile(e.thresholds.bosCoster);
+        e.thresholds.bdlo12 = fromFile(e.thresholds.bdlo12);
+        e.thresholds.pippenger = fromFile(e.thresholds.pippenger);
+        entries.push_back(e);
+    }
+
+    return entries;
+}
+
+void writeMultiExpProfile(const std::string& file, const std::vector<MultiExpProfileEntry>& entries) {
+    ofstream fout(file);
+    if(fout.fail()) {
+        throw std::runtime_error("Could not open multiexp profile '" + file + "' for writing");
+    }
+
+    fout << "# <group> <num-threads> <bos-coster> <bdlo12> <pippenger> (0 means never)" << endl;
+    for(auto& e : entries) {
+        fout << e.group << " " << e.numThreads << " "
+             << toFile(e.thresholds.bosCoster) << " "
+             << toFile(e.thresholds.bdlo12) << " "
+             << toFile(e.thresholds.pippenger) << endl;
+    }
+}
+
+bool loadMultiExpProfile(const std::string& file) {
+    bool foundG1 = false, foundG2 = false;
+    MultiExpThresholds g1th, g2th;
+    for(auto& e : readMultiExpProfile(file)) {
+        if(e.numThreads != getNumCores())
+            continue;
+
+        if(e.group == "G1") {
+            g1th = e.thresholds;
+            foundG1 = true;
+        } else {
+            g2th = e.thresholds;
+            foundG2 = true;
+        }
+    }
+
+    if(!foundG1 || !foundG2)
+        return false;
+
+    getMultiExpThresholds<G1>() = g1th;
+    getMultiExpThresholds<G2>() = g2th;
+    return true;
+}
+
+template<class Group>
+MultiExpThresholds calibrateMultiExp(size_t numThreads, size_t maxSize, size_t minMillis) {
+#ifdef USE_MULTITHREADING
+    omp_set_num_threads(static_cast<int>(numThreads));
+#endif
+
+    // best[k] is the fastest method for multiexps of size 2^{k+1}
+    std::vector<int> best;
+    bool tooSlow[NumMethods] = { false, false, false, false };
+    for(size_t n = 2; n <= maxSize; n *= 2) {
+        std::vector<Group> bases = random_group_elems<Group>(n);
+        std::vector<Fr> exps = random_field_elems(n);
+
+        double times[NumMethods] = { 0, 0, 0, 0 };
+        int fastest = -1;
+        for(int m = 0; m < NumMethods; m++) {
+            if(tooSlow[m])
+                continue;
+
+            times[m] = timeMethod<Group>(m, bases, exps, numThreads, minMillis);
+            if(fastest == -1 || times[m] < times[fastest])
+                fastest = m;
+        }
+
+        // a method that is far behind will not catch up at bigger sizes, so stop timing it
+        for(int m = 0; m < NumMethods; m++) {
+            if(!tooSlow[m] && times[m] > 4 * times[fastest]) {
+                tooSlow[m] = true;
+            }
+        }
+
+        logdbg << groupName<Group>() << ", " << numThreads << " threads, n = " << n << ": " << methodName(fastest)
+               << " (" << times[fastest] << " mus)" << endl;
+        best.push_back(fastest);
+    }
+
+#ifdef USE_MULTITHREADING
+    omp_set_num_threads(static_cast<int>(getNumCores()));
+#endif
+
+    // the threshold for a method is the smallest size from which on it, or a later one, is always the fastest
+    size_t thresholds[NumMethods];
+    for(int m = BosCoster; m < NumMethods; m++) {
+        thresholds[m] = Never;
+        for(size_t k = best.size(); k > 0 && best[k - 1] >= m; k--) {
+            thresholds[m] = static_cast<size_t>(1) << k;
+        }
+    }
+
+    MultiExpThresholds th;
+    th.bosCoster = thresholds[BosCoster];
+    th.bdlo12 = thresholds[BDLO12];
+    th.pippenger = thresholds[Pippenger];
+    return th;
+}
+
+template MultiExpThresholds calibrateMultiExp<G1>(size_t numThreads, size_t maxSize, size_t minMillis);
+template MultiExpThresholds calibrateMultiExp<G2>(size_t numThreads, size_t maxSize, size_t minMillis);
+
+} // end of namespace libpolycrypto
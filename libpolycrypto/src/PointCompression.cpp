@@ -0,0 +1,442 @@
+#include <polycrypto/Configuration.h>
+
+#include <polycrypto/PointCompression.h>
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <gmp.h>
+
+using namespace std;
+
+namespace libpolycrypto {
+
+#if defined(CURVE_BN128) || defined(CURVE_ALT_BN128)
+
+namespace {
+
+/**
+ * Writes a < 2^{8 FieldElementBytes} to out as FieldElementBytes big-endian bytes.
+ */
+void mpzToBytes(const mpz_t a, unsigned char * out) {
+    std::fill(out, out + FieldElementBytes, static_cast<unsigned char>(0));
+    size_t numBytes = (mpz_sizeinbase(a, 2) + 7) / 8;
+    mpz_export(out + (FieldElementBytes - numBytes), nullptr, 1, 1, 1, 0, a);
+}
+
+/**
+ * Arithmetic modulo the base field characteristic q, and in Fq2 = Fq[u]/(u^2 + 1), on GMP integers,
+ * which is all that decompression needs: y^2 = x^3 + b and a square root.
+ *
+ * Both BN-P254 curves have q = 3 mod 4, so -1 is not a square in Fq (hence the Fq2 above), and the
+ * square root of a square a in Fq is a^{(q+1)/4}. When a is not a square, that root squares to -a
+ * instead, so checking the root is the same as checking Euler's criterion a^{(q-1)/2} = 1, at no
+ * extra cost. This is why we do not call libff's Tonelli-Shanks, which never terminates on
+ * non-squares: decompression must reject any bytes an adversary sends.
+ */
+class BaseField {
+public:
+    mpz_t q;
+    mpz_t sqrtExp;  // (q+1)/4
+    mpz_t halfInv;  // 1/2 mod q
+
+public:
+    BaseField() {
+        mpz_inits(q, sqrtExp, halfInv, nullptr);
+        G1::base_field_char().to_mpz(q);
+        if(mpz_fdiv_ui(q, 4) != 3) {
+            throw std::runtime_error("Point decompression needs a base field with q = 3 mod 4");
+        }
+
+        mpz_add_ui(sqrtExp, q, 1);
+        mpz_fdiv_q_2exp(sqrtExp, sqrtExp, 2);
+        mpz_add_ui(halfInv, q, 1);
+        mpz_fdiv_q_2exp(halfInv, halfInv, 1);
+    }
+
+    ~BaseField() {
+        mpz_clears(q, sqrtExp, halfInv, nullptr);
+    }
+
+    BaseField(const BaseField&) = delete;
+    BaseField& operator=(const BaseField&) = delete;
+
+public:
+    static const BaseField& get() {
+        // NOTE: thread-safe since C++11
+        static const BaseField f;
+        return f;
+    }
+
+    void mulMod(mpz_t r, const mpz_t a, const mpz_t b) const {
+        mpz_mul(r, a, b);
+        mpz_mod(r, r, q);
+    }
+
+    void negMod(mpz_t r, const mpz_t a) const {
+        mpz_neg(r, a);
+        mpz_mod(r, r, q);
+    }
+
+    /**
+     * Sets r to a square root of a (reduced mod q) and returns true, or returns false if a is not a square.
+     */
+    bool sqrt(mpz_t r, const mpz_t a) const {
+        mpz_t r2;
+        mpz_init(r2);
+        mpz_powm(r, a, sqrtExp, q);
+        mulMod(r2, r, r);
+        bool isSquare = mpz_cmp(r2, a) == 0;
+        mpz_clear(r2);
+        return isSquare;
+    }
+
+    /**
+     * Sets (r0, r1) to (a0 + a1 u)^2 in Fq2. The outputs must not alias the inputs.
+     */
+    void sqr2(mpz_t r0, mpz_t r1, const mpz_t a0, const mpz_t a1) const {
+        mpz_t t;
+        mpz_init(t);
+        mpz_mul(t, a0, a1);
+        mpz_mul_2exp(t, t, 1);
+        // (a0 + a1 u)^2 = (a0 + a1)(a0 - a1) + 2 a0 a1 u
+        mpz_add(r0, a0, a1);
+        mpz_sub(r1, a0, a1);
+        mpz_mul(r0, r0, r1);
+        mpz_mod(r0, r0, q);
+        mpz_mod(r1, t, q);
+        mpz_clear(t);
+    }
+
+    /**
+     * Sets (r0, r1) to (a0 + a1 u)(b0 + b1 u) in Fq2. The outputs must not alias the inputs.
+     */
+    void mul2(mpz_t r0, mpz_t r1, const mpz_t a0, const mpz_t a1, const mpz_t b0, const mpz_t b1) const {
+        mpz_t t;
+        mpz_init(t);
+        mpz_mul(r0, a0, b0);
+        mpz_mul(t, a1, b1);
+        mpz_sub(r0, r0, t);
+        mpz_mod(r0, r0, q);
+        mpz_mul(r1, a0, b1);
+        mpz_mul(t, a1, b0);
+        mpz_add(r1, r1, t);
+        mpz_mod(r1, r1, q);
+        mpz_clear(t);
+    }
+
+    /**
+     * Sets (r0, r1) to a square root of a = a0 + a1 u (reduced mod q) in Fq2 and returns true,
+     * or returns false if a is not a square. The outputs must not alias the inputs.
+     *
+     * a is a square iff its norm a0^2 + a1^2 is a square in Fq (i.e., iff a^{(q^2-1)/2} = 1).
+     * Then, r0^2 - r1^2 = a0 and 2 r0 r1 = a1 give r0^2 = (a0 +/- n)/2, where n^2 is the norm,
+     * and exactly one of the two signs gives a square in Fq, since their product -a1^2/4 is not one.
+     */
+    bool sqrt2(mpz_t r0, mpz_t r1, const mpz_t a0, const mpz_t a1) const {
+        bool isSquare = false;
+        mpz_t n, t, c0, c1;
+        mpz_inits(n, t, c0, c1, nullptr);
+
+        if(mpz_sgn(a1) == 0) {
+            // a is in Fq, so either a or -a is a square there, and sqrt(-a) u squares to a
+            if(sqrt(r0, a0)) {
+                mpz_set_ui(r1, 0);
+                isSquare = true;
+            } else {
+                negMod(t, a0);
+                isSquare = sqrt(r1, t);
+                mpz_set_ui(r0, 0);
+            }
+        } else {
+            mpz_mul(t, a0, a0);
+            mpz_addmul(t, a1, a1);
+            mpz_mod(t, t, q);
+
+            if(sqrt(n, t)) {
+                mpz_add(t, a0, n);
+                mulMod(t, t, halfInv);
+                if(!sqrt(r0, t)) {
+                    mpz_sub(t, a0, n);
+                    mulMod(t, t, halfInv);
+                    isSquare = sqrt(r0, t);
+                } else {
+                    isSquare = true;
+                }
+
+                // r0 != 0, since otherwise a1 = 2 r0 r1 would be 0
+                if(isSquare) {
+                    mpz_mul_2exp(t, r0, 1);
+                    isSquare = mpz_invert(t, t, q) != 0;
+                    mulMod(r1, a1, t);
+                }
+            }
+        }
+
+        // cheap sanity check, since a wrong root would give a point that is not on the curve
+        if(isSquare) {
+            sqr2(c0, c1, r0, r1);
+            isSquare = mpz_cmp(c0, a0) == 0 && mpz_cmp(c1, a1) == 0;
+        }
+
+        mpz_clears(n, t, c0, c1, nullptr);
+        return isSquare;
+    }
+
+    /**
+     * Reads a field element from FieldElementBytes big-endian bytes (ignoring the flags in the first
+     * byte if 'clearFlags' is set) and returns false if it is not reduced mod q.
+     */
+    bool fromBytes(mpz_t a, const unsigned char * in, bool clearFlags) const {
+        unsigned char slot[FieldElementBytes];
+        std::copy(in, in + FieldElementBytes, slot);
+        if(clearFlags) {
+            slot[0] = static_cast<unsigned char>(slot[0] & ~(PointInfinityFlag | PointSignFlag));
+        }
+
+        mpz_import(a, FieldElementBytes, 1, 1, 1, 0, slot);
+        return mpz_cmp(a, q) < 0;
+    }
+};
+
+/**
+ * Converts between libff points and the integer values of their affine coordinates.
+ * Each Fq2 coordinate c0 + c1 u is passed as two integers c0 and c1.
+ */
+#if defined(CURVE_ALT_BN128)
+typedef libff::alt_bn128_Fq Fq;
+typedef libff::alt_bn128_Fq2 Fq2;
+typedef libff::bigint<Fq::num_limbs> FqBigInt;
+
+void getAffine(const G1& p, mpz_t x, mpz_t y) {
+    G1 a(p);
+    a.to_affine_coordinates();
+    a.X.as_bigint().to_mpz(x);
+    a.Y.as_bigint().to_mpz(y);
+}
+
+void getAffine(const G2& p, mpz_t x0, mpz_t x1, mpz_t y0, mpz_t y1) {
+    G2 a(p);
+    a.to_affine_coordinates();
+    a.X.c0.as_bigint().to_mpz(x0);
+    a.X.c1.as_bigint().to_mpz(x1);
+    a.Y.c0.as_bigint().to_mpz(y0);
+    a.Y.c1.as_bigint().to_mpz(y1);
+}
+
+G1 fromAffine(const mpz_t x, const mpz_t y) {
+    return G1(Fq(FqBigInt(x)), Fq(FqBigInt(y)), Fq::one());
+}
+
+G2 fromAffine(const mpz_t x0, const mpz_t x1, const mpz_t y0, const mpz_t y1) {
+    return G2(
+        Fq2(Fq(FqBigInt(x0)), Fq(FqBigInt(x1))),
+        Fq2(Fq(FqBigInt(y0)), Fq(FqBigInt(y1))),
+        Fq2::one());
+}
+
+void getCoeffB(mpz_t b) {
+    libff::alt_bn128_coeff_b.as_bigint().to_mpz(b);
+}
+
+void getTwistCoeffB(mpz_t b0, mpz_t b1) {
+    libff::alt_bn128_twist_coeff_b.c0.as_bigint().to_mpz(b0);
+    libff::alt_bn128_twist_coeff_b.c1.as_bigint().to_mpz(b1);
+}
+#else
+// NOTE: BN128's coordinates are ate-pairing's bn::Fp, which only converts to and from integers
+// through its own decimal I/O (unlike its points, this does not depend on libff's build flags).
+void fpToMpz(const bn::Fp& a, mpz_t r) {
+    std::ostringstream ss;
+    ss << a;
+    if(mpz_set_str(r, ss.str().c_str(), 0) != 0) {
+        throw std::runtime_error("Could not parse bn::Fp '" + ss.str() + "'");
+    }
+}
+
+bn::Fp mpzToFp(const mpz_t a) {
+    char * str = mpz_get_str(nullptr, 10, a);
+    bn::Fp r(str);
+
+    void (*freefunc)(void *, size_t);
+    mp_get_memory_functions(nullptr, nullptr, &freefunc);
+    freefunc(str, strlen(str) + 1);
+    return r;
+}
+
+void getAffine(const G1& p, mpz_t x, mpz_t y) {
+    G1 a(p);
+    a.to_affine_coordinates();
+    fpToMpz(a.X, x);
+    fpToMpz(a.Y, y);
+}
+
+void getAffine(const G2& p, mpz_t x0, mpz_t x1, mpz_t y0, mpz_t y1) {
+    G2 a(p);
+    a.to_affine_coordinates();
+    fpToMpz(a.X.a_, x0);
+    fpToMpz(a.X.b_, x1);
+    fpToMpz(a.Y.a_, y0);
+    fpToMpz(a.Y.b_, y1);
+}
+
+G1 fromAffine(const mpz_t x, const mpz_t y) {
+    bn::Fp coord[3] = { mpzToFp(x), mpzToFp(y), bn::Fp("1") };
+    return G1(coord);
+}
+
+G2 fromAffine(const mpz_t x0, const mpz_t x1, const mpz_t y0, const mpz_t y1) {
+    bn::Fp2 coord[3];
+    coord[0].a_ = mpzToFp(x0);
+    coord[0].b_ = mpzToFp(x1);
+    coord[1].a_ = mpzToFp(y0);
+    coord[1].b_ = mpzToFp(y1);
+    coord[2].a_ = bn::Fp("1");
+    coord[2].b_ = bn::Fp("0");
+    return G2(coord);
+}
+
+void getCoeffB(mpz_t b) {
+    fpToMpz(libff::bn128_coeff_b, b);
+}
+
+void getTwistCoeffB(mpz_t b0, mpz_t b1) {
+    fpToMpz(libff::bn128_twist_coeff_b.a_, b0);
+    fpToMpz(libff::bn128_twist_coeff_b.b_, b1);
+}
+#endif
+
+} // end of anonymous namespace
+
+template<>
+bool compressX<G1>(const G1& p, unsigned char * out) {
+    mpz_t x, y;
+    mpz_inits(x, y, nullptr);
+    getAffine(p, x, y);
+
+    mpzToBytes(x, out);
+    bool sign = mpz_odd_p(y) != 0;
+
+    mpz_clears(x, y, nullptr);
+    return sign;
+}
+
+template<>
+bool compressX<G2>(const G2& p, unsigned char * out) {
+    mpz_t x0, x1, y0, y1;
+    mpz_inits(x0, x1, y0, y1, nullptr);
+    getAffine(p, x0, x1, y0, y1);
+
+    mpzToBytes(x0, out);
+    mpzToBytes(x1, out + FieldElementBytes);
+    bool sign = mpz_sgn(y0) != 0 ? mpz_odd_p(y0) != 0 : mpz_odd_p(y1) != 0;
+
+    mpz_clears(x0, x1, y0, y1, nullptr);
+    return sign;
+}
+
+template<>
+G1 decompressX<G1>(const unsigned char * in, bool sign) {
+    const BaseField& f = BaseField::get();
+    const char * error = nullptr;
+    G1 p;
+
+    mpz_t x, y, y2;
+    mpz_inits(x, y, y2, nullptr);
+
+    if(!f.fromBytes(x, in, true)) {
+        error = "Compressed point has a non-canonical x coordinate";
+    } else {
+        // y^2 = x^3 + b
+        getCoeffB(y2);
+        mpz_t x3;
+        mpz_init(x3);
+        mpz_powm_ui(x3, x, 3, f.q);
+        mpz_add(y2, y2, x3);
+        mpz_mod(y2, y2, f.q);
+        mpz_clear(x3);
+
+        if(!f.sqrt(y, y2)) {
+            error = "Compressed point is not on the curve";
+        } else {
+            if((mpz_odd_p(y) != 0) != sign)
+                f.negMod(y, y);
+
+            p = fromAffine(x, y);
+        }
+    }
+
+    mpz_clears(x, y, y2, nullptr);
+    if(error != nullptr) {
+        throw std::runtime_error(error);
+    }
+    return p;
+}
+
+template<>
+G2 decompressX<G2>(const unsigned char * in, bool sign) {
+    const BaseField& f = BaseField::get();
+    const char * error = nullptr;
+    G2 p;
+
+    mpz_t x0, x1, y0, y1, s0, s1, t0, t1;
+    mpz_inits(x0, x1, y0, y1, s0, s1, t0, t1, nullptr);
+
+    if(!f.fromBytes(x0, in, true) || !f.fromBytes(x1, in + FieldElementBytes, false)) {
+        error = "Compressed point has a non-canonical x coordinate";
+    } else {
+        // y^2 = x^3 + b, over Fq2
+        f.sqr2(s0, s1, x0, x1);
+        f.mul2(t0, t1, s0, s1, x0, x1);
+        getTwistCoeffB(s0, s1);
+        mpz_add(t0, t0, s0);
+        mpz_mod(t0, t0, f.q);
+        mpz_add(t1, t1, s1);
+        mpz_mod(t1, t1, f.q);
+
+        if(!f.sqrt2(y0, y1, t0, t1)) {
+            error = "Compressed point is not on the curve";
+        } else {
+            bool ySign = mpz_sgn(y0) != 0 ? mpz_odd_p(y0) != 0 : mpz_odd_p(y1) != 0;
+            if(ySign != sign) {
+                f.negMod(y0, y0);
+                f.negMod(y1, y1);
+            }
+
+            p = fromAffine(x0, x1, y0, y1);
+        }
+    }
+
+    mpz_clears(x0, x1, y0, y1, s0, s1, t0, t1, nullptr);
+    if(error != nullptr) {
+        throw std::runtime_error(error);
+    }
+    return p;
+}
+
+#else
+
+template<>
+bool compressX<G1>(const G1&, unsigned char *) {
+    throw std::runtime_error("Point compression is only implemented for the BN-P254 curves");
+}
+
+template<>
+bool compressX<G2>(const G2&, unsigned char *) {
+    throw std::runtime_error("Point compression is only implemented for the BN-P254 curves");
+}
+
+template<>
+G1 decompressX<G1>(const unsigned char *, bool) {
+    throw std::runtime_error("Point compression is only implemented for the BN-P254 curves");
+}
+
+template<>
+G2 decompressX<G2>(const unsigned char *, bool) {
+    throw std::runtime_error("Point compression is only implemented for the BN-P254 curves");
+}
+
+#endif
+
+} // end of namespace libpolycrypto
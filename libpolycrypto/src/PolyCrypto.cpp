@@ -1,5 +1,7 @@
+#include <cstdlib>
 #include <fstream>
 #include <algorithm>
+#include <limits>
 #include <thread>
 
 #include <boost/functional/hash.hpp>
@@ -7,7 +9,9 @@
 #include <polycrypto/NtlLib.h>
 #include <polycrypto/Configuration.h>
 #include <polycrypto/PolyCrypto.h>
+#include <polycrypto/MultiExpProfile.h>
 #include <polycrypto/RootsOfUnityEval.h>
+#include <polycrypto/ScalarMult.h>
 
 #include <libff/common/profiling.hpp>
 #include <libff/algebra/fields/field_utils.hpp> // get_root_of_unity
@@ -21,6 +25,93 @@ using namespace NTL;
 
 namespace libpolycrypto {
 
+PreparedG2::PreparedG2()
+    : isZero(true)
+{
+}
+
+PreparedG2::PreparedG2(const G2& q)
+    : isZero(q.is_zero())
+{
+    // libff does not handle the point at infinity in its Miller loops, but e(p, 0) = 1 anyway
+    if(!isZero)
+        prec = libff::default_ec_pp::precompute_G2(q);
+}
+
+const PreparedG2& preparedG2One() {
+    // NOTE: thread-safe since C++11
+    static const PreparedG2 g2(G2::one());
+    return g2;
+}
+
+Fqk MillerLoop(const G1& p, const G2& q) {
+    return MillerLoop(p, PreparedG2(q));
+}
+
+Fqk MillerLoop(const G1& p, const PreparedG2& q) {
+    typedef libff::default_ec_pp ppT;
+
+    // e(0, q) = e(p, 0) = 1, but libff does not handle the point at infinity in its Miller loops
+    if(p.is_zero() || q.is_zero())
+        return Fqk::one();
+
+    return ppT::miller_loop(ppT::precompute_G1(p), q.getLineCoeffs());
+}
+
+Fqk MultiMillerLoop(const std::vector<G1>& ps, const std::vector<G2>& qs) {
+    std::vector<PreparedG2> prepared;
+    std::vector<const PreparedG2*> ptrs;
+    prepared.reserve(qs.size());
+    for(auto& q : qs) {
+        prepared.push_back(PreparedG2(q));
+        ptrs.push_back(&prepared.back());
+    }
+
+    return MultiMillerLoop(ps, ptrs);
+}
+
+Fqk MultiMillerLoop(const std::vector<G1>& ps, const std::vector<const PreparedG2*>& qs) {
+    typedef libff::default_ec_pp ppT;
+
+    if(ps.size() != qs.size()) {
+        throw std::runtime_error("Need as many G1 as G2 elements for a multi-pairing");
+    }
+
+    // the pairings we actually have to compute (see MillerLoop)
+    std::vector<size_t> idxs;
+    for(size_t i = 0; i < ps.size(); i++) {
+        if(!ps[i].is_zero() && !qs[i]->is_zero())
+            idxs.push_back(i);
+    }
+
+    Fqk f = Fqk::one();
+    size_t j = 0;
+    for(; j + 1 < idxs.size(); j += 2) {
+        size_t a = idxs[j], b = idxs[j + 1];
+        f = f * ppT::double_miller_loop(
+            ppT::precompute_G1(ps[a]), qs[a]->getLineCoeffs(),
+            ppT::precompute_G1(ps[b]), qs[b]->getLineCoeffs());
+    }
+
+    if(j < idxs.size()) {
+        f = f * MillerLoop(ps[idxs[j]], *qs[idxs[j]]);
+    }
+
+    return f;
+}
+
+GT FinalExponentiation(const Fqk& f) {
+    return libff::default_ec_pp::final_exponentiation(f);
+}
+
+GT MultiPairing(const std::vector<G1>& ps, const std::vector<G2>& qs) {
+    return FinalExponentiation(MultiMillerLoop(ps, qs));
+}
+
+GT MultiPairing(const std::vector<G1>& ps, const std::vector<const PreparedG2*>& qs) {
+    return FinalExponentiation(MultiMillerLoop(ps, qs));
+}
+
 void initialize(unsigned char * randSeed, int size) {
     (void)randSeed; // TODO: initialize entropy source
     (void)size;     // TODO: initialize entropy source
@@ -31,6 +122,9 @@ void initialize(unsigned char * randSeed, int size) {
     // Initializes the default EC curve, so as to avoid "surprises"
     libff::default_ec_pp::init_public_params();
 
+    // Makes sure the GLV/GLS constants match the curve, since scalarMul() would silently be wrong otherwise
+    checkEndomorphisms();
+
     // Initializes the NTL finite field
     ZZ p = conv<ZZ> ("21888242871839275222246405745257275088548364400416034343698204186575808495617");
     ZZ_p::init(p);
@@ -45,6 +139,44 @@ void initialize(unsigned char * randSeed, int size) {
 #else
     //loginfo << "NOT using multithreading" << endl;
 #endif
+
+    // Use this machine's multiexp thresholds, if it was calibrated (see BenchMultiexp calibrate)
+    const char * profileFile = getenv(MultiExpProfileEnvVar);
+    if(profileFile != nullptr) {
+        if(loadMultiExpProfile(profileFile)) {
+            loginfo << "Loaded multiexp profile from '" << profileFile << "'" << endl;
+        } else {
+            logwarn << "Multiexp profile '" << profileFile << "' has no entry for " << getNumCores() << " threads; using the defaults" << endl;
+        }
+    }
+}
+
+namespace {
+
+MultiExpThresholds defaultMultiExpThresholds() {
+    MultiExpThresholds th;
+    th.bosCoster = 5;
+    th.bdlo12 = 16385;
+#ifdef USE_MULTITHREADING
+    th.pippenger = 1024;
+#else
+    th.pippenger = std::numeric_limits<size_t>::max();
+#endif
+    return th;
+}
+
+} // end of anonymous namespace
+
+template<>
+MultiExpThresholds& getMultiExpThresholds<G1>() {
+    static MultiExpThresholds th = defaultMultiExpThresholds();
+    return th;
+}
+
+template<>
+MultiExpThresholds& getMultiExpThresholds<G2>() {
+    static MultiExpThresholds th = defaultMultiExpThresholds();
+    return th;
 }
 
 vector<Fr> random_field_elems(size_t num) {
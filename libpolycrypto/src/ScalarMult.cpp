@@ -0,0 +1,303 @@
+#include <polycrypto/Configuration.h>
+
+#include <polycrypto/ScalarMult.h>
+#include <polycrypto/Pippenger.h>
+
+#include <stdexcept>
+
+using namespace std;
+
+namespace libpolycrypto {
+
+namespace {
+
+/**
+ * Sets q to round(n / d).
+ */
+void roundDiv(mpz_t q, const mpz_t n, const mpz_t d) {
+    mpz_t num, den;
+    mpz_init(num);
+    mpz_init(den);
+
+    // round(n / d) = floor((2n + d) / 2d), for d > 0
+    if(mpz_sgn(d) < 0) {
+        mpz_neg(num, n);
+        mpz_neg(den, d);
+    } else {
+        mpz_set(num, n);
+        mpz_set(den, d);
+    }
+    mpz_mul_2exp(num, num, 1);
+    mpz_add(num, num, den);
+    mpz_mul_2exp(den, den, 1);
+    mpz_fdiv_q(q, num, den);
+
+    mpz_clear(num);
+    mpz_clear(den);
+}
+
+/**
+ * Precomputed d 2^{wj} g for the generator g of the group, every window j and every w-bit digit
+ * d != 0, in affine form.
+ */
+template<class Group>
+class GeneratorTable {
+protected:
+    static const size_t NumDigits = (static_cast<size_t>(1) << GeneratorWindowSize) - 1;
+
+    size_t numWindows;
+    std::vector<Group> table;   // table[j * NumDigits + d - 1] = d 2^{wj} g
+
+public:
+    GeneratorTable()
+        : numWindows((Fr::size_in_bits() + GeneratorWindowSize - 1) / GeneratorWindowSize),
+          table(numWindows * NumDigits)
+    {
+        // the 2^{wj} g's are a chain of doublings...
+        std::vector<Group> bases(numWindows);
+        bases[0] = Group::one();
+        for(size_t j = 1; j < numWindows; j++) {
+            bases[j] = bases[j - 1];
+            for(size_t b = 0; b < GeneratorWindowSize; b++) {
+                bases[j] = bases[j].dbl();
+            }
+        }
+
+        // ...but the rows can be filled in in parallel
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for
+#endif
+        for(size_t j = 0; j < numWindows; j++) {
+            Group * row = table.data() + j * NumDigits;
+            row[0] = bases[j];
+            for(size_t d = 1; d < NumDigits; d++) {
+                row[d] = row[d - 1] + bases[j];
+            }
+        }
+
+        libff::batch_to_special(table);
+    }
+
+public:
+    static const GeneratorTable& get() {
+        static const GeneratorTable t;
+        return t;
+    }
+
+    Group exp(const Fr& k) const {
+        auto b = k.as_bigint();
+        Group result = Group::zero();
+        for(size_t j = 0; j < numWindows; j++) {
+            size_t d = pippengerDigit(b, j * GeneratorWindowSize, GeneratorWindowSize);
+            if(d != 0)
+                result = result.mixed_add(table[j * NumDigits + d - 1]);
+        }
+        return result;
+    }
+
+    std::vector<Group> expBatch(const std::vector<Fr>& ks) const {
+        std::vector<Group> results(ks.size());
+#ifdef USE_MULTITHREADING
+#pragma omp parallel for
+#endif
+        for(size_t i = 0; i < ks.size(); i++) {
+            results[i] = exp(ks[i]);
+        }
+
+        libff::batch_to_special(results);
+        return results;
+    }
+};
+
+} // end of anonymous namespace
+
+G1 g1Exp(const Fr& k) {
+    return GeneratorTable<G1>::get().exp(k);
+}
+
+G2 g2Exp(const Fr& k) {
+    return GeneratorTable<G2>::get().exp(k);
+}
+
+std::vector<G1> g1ExpBatch(const std::vector<Fr>& ks) {
+    return GeneratorTable<G1>::get().expBatch(ks);
+}
+
+std::vector<G2> g2ExpBatch(const std::vector<Fr>& ks) {
+    return GeneratorTable<G2>::get().expBatch(ks);
+}
+
+GlvBasis::GlvBasis(const Fr& lambda) {
+    if(lambda.is_zero()) {
+        throw std::runtime_error("GLV eigenvalue cannot be zero");
+    }
+
+    mpz_inits(a1, b1, a2, b2, det, nullptr);
+
+    mpz_t r, sqrtR, r0, r1, r2, t0, t1, t2, q;
+    mpz_inits(r, sqrtR, r0, r1, r2, t0, t1, t2, q, nullptr);
+
+    Fr::field_char().to_mpz(r);
+    mpz_sqrt(sqrtR, r);
+
+    // r_i = s_i r + t_i \lambda, so (r_i, -t_i) is in the lattice
+    mpz_set(r0, r);
+    lambda.as_bigint().to_mpz(r1);
+    mpz_set_ui(t0, 0);
+    mpz_set_ui(t1, 1);
+    while(mpz_cmp(r1, sqrtR) >= 0) {
+        mpz_fdiv_q(q, r0, r1);
+
+        mpz_submul(r0, q, r1);
+        mpz_swap(r0, r1);
+        mpz_submul(t0, q, t1);
+        mpz_swap(t0, t1);
+    }
+
+    // now r0 >= \sqrt{r} > r1, so (r1, -t1) is the first short vector...
+    mpz_set(a1, r1);
+    mpz_neg(b1, t1);
+
+    // ...and the second one is the shorter of (r0, -t0) and the next one in the sequence
+    mpz_fdiv_q(q, r0, r1);
+    mpz_set(r2, r0);
+    mpz_submul(r2, q, r1);
+    mpz_set(t2, t0);
+    mpz_submul(t2, q, t1);
+
+    mpz_t n0, n2;
+    mpz_inits(n0, n2, nullptr);
+    mpz_mul(n0, r0, r0);
+    mpz_addmul(n0, t0, t0);
+    mpz_mul(n2, r2, r2);
+    mpz_addmul(n2, t2, t2);
+    if(mpz_cmp(n0, n2) <= 0) {
+        mpz_set(a2, r0);
+        mpz_neg(b2, t0);
+    } else {
+        mpz_set(a2, r2);
+        mpz_neg(b2, t2);
+    }
+
+    mpz_mul(det, a1, b2);
+    mpz_submul(det, a2, b1);
+
+    mpz_clears(n0, n2, r, sqrtR, r0, r1, r2, t0, t1, t2, q, nullptr);
+}
+
+GlvBasis::~GlvBasis() {
+    mpz_clears(a1, b1, a2, b2, det, nullptr);
+}
+
+void GlvBasis::decompose(const Fr& k, mpz_t k1, mpz_t k2) const {
+    mpz_t kz, c1, c2, tmp;
+    mpz_inits(kz, c1, c2, tmp, nullptr);
+    k.as_bigint().to_mpz(kz);
+
+    // (k, 0) = c1 (a1, b1) + c2 (a2, b2) over the rationals, so c1 = k b2 / det and c2 = -k b1 / det
+    mpz_mul(tmp, kz, b2);
+    roundDiv(c1, tmp, det);
+    mpz_mul(tmp, kz, b1);
+    mpz_neg(tmp, tmp);
+    roundDiv(c2, tmp, det);
+
+    // (k1, k2) = (k, 0) - c1 (a1, b1) - c2 (a2, b2) is a short vector with k1 + k2\lambda = k
+    mpz_set(k1, kz);
+    mpz_submul(k1, c1, a1);
+    mpz_submul(k1, c2, a2);
+    mpz_set_ui(k2, 0);
+    mpz_submul(k2, c1, b1);
+    mpz_submul(k2, c2, b2);
+
+    mpz_clears(kz, c1, c2, tmp, nullptr);
+}
+
+#if defined(CURVE_BN128) || defined(CURVE_ALT_BN128)
+/**
+ * NOTE: libff's BN128 (via ate-pairing) and ALT_BN128 are the same BN-P254 curve, with the same
+ * q and r (see bn128_init.cpp), so they share \beta and \lambda. checkEndomorphisms() makes sure.
+ */
+namespace {
+
+// \beta is a cube root of unity in Fq such that (\beta x, y) = \lambda (x, y) on G1
+# if defined(CURVE_BN128)
+typedef bn::Fp BaseField;
+# else
+typedef libff::alt_bn128_Fq BaseField;
+# endif
+
+const BaseField& getBeta() {
+    static const BaseField beta("2203960485148121921418603742825762020974279258880205651966");
+    return beta;
+}
+
+template<class Field>
+bool isCubeRootOfUnity(const Field& x, const Field& one) {
+    return x != one && x * x * x == one;
+}
+
+} // end of anonymous namespace
+
+G1 Endomorphism<G1>::apply(const G1& p) {
+    // in Jacobian coordinates, x = X / Z^2, so scaling X scales x
+    G1 r = p;
+    r.X = r.X * getBeta();
+    return r;
+}
+
+const Fr& Endomorphism<G1>::getEigenvalue() {
+    static const Fr lambda("4407920970296243842393367215006156084916469457145843978461");
+    return lambda;
+}
+
+const GlvBasis& Endomorphism<G1>::getBasis() {
+    static const GlvBasis basis(getEigenvalue());
+    return basis;
+}
+#endif
+
+#if defined(CURVE_ALT_BN128)
+G2 Endomorphism<G2>::apply(const G2& p) {
+    return p.mul_by_q();
+}
+
+const Fr& Endomorphism<G2>::getEigenvalue() {
+    // p mod r = 6u^2, where u = 4965661367192848881 is the BN parameter
+    static const Fr lambda("147946756881789318990833708069417712966");
+    return lambda;
+}
+
+const GlvBasis& Endomorphism<G2>::getBasis() {
+    static const GlvBasis basis(getEigenvalue());
+    return basis;
+}
+#endif
+
+namespace {
+
+template<class Group>
+void checkEndomorphism(std::true_type) {
+    const Group& g = Group::one();
+    if(Endomorphism<Group>::apply(g) != Endomorphism<Group>::getEigenvalue() * g) {
+        throw std::runtime_error("The GLV endomorphism does not act as multiplication by its eigenvalue");
+    }
+}
+
+template<class Group>
+void checkEndomorphism(std::false_type) {
+}
+
+} // end of anonymous namespace
+
+void checkEndomorphisms() {
+#if defined(CURVE_BN128) || defined(CURVE_ALT_BN128)
+    if(!isCubeRootOfUnity(getBeta(), BaseField(1)) || !isCubeRootOfUnity(Endomorphism<G1>::getEigenvalue(), Fr::one())) {
+        throw std::runtime_error("The GLV constants for G1 are not cube roots of unity");
+    }
+#endif
+
+    checkEndomorphism<G1>(std::integral_constant<bool, Endomorphism<G1>::Enabled>());
+    checkEndomorphism<G2>(std::integral_constant<bool, Endomorphism<G2>::Enabled>());
+}
+
+} // end of namespace libpolycrypto
@@ -83,24 +83,38 @@ int main(int argc, char *argv[]) {
 
                 std::vector<Fr> f = random_field_elems(t);
 
-                // Step 1: Fast multipoint eval
-                DkgParams params(t, n, true);
-                params.setAuthAccumulators(&authAccs);
-                RootsOfUnityEvaluation eval(f, *params.accs);
-
-                // Step 2: Authenticate Multipoint Evaluation
-                //loginfo << "Computing AMT: ";
-                for(bool isSimulated : { true, false }) {
-                    AuthRootsOfUnityEvaluation authEval(eval, kpp, isSimulated);
-
-                    // Verify all monomial commitments
-                    for(size_t i = 0; i < n; i++) {
-                        const auto& vk = params.getMonomialCommitment(i);
-                        //loginfo << "vk[" << i << "]: " << vk << endl;
-
-                        testAssertEqual(
-                            kpp.getG2toS() - params.omegas[i] * G2::one(), 
-                            vk);
+                for(size_t arity : std::vector<size_t>{ 2, 4 }) {
+                    // Step 1: Fast multipoint eval
+                    DkgParams params(t, n, true, arity);
+                    params.setAuthAccumulators(&authAccs);
+                    RootsOfUnityEvaluation eval(f, *params.accs, arity);
+                    testAssertEqual(eval.getMaxLevel(), params.maxLevel);
+
+                    // Step 2: Authenticate Multipoint Evaluation
+                    //loginfo << "Computing AMT: ";
+                    for(bool isSimulated : { true, false }) {
+                        AuthRootsOfUnityEvaluation authEval(eval, kpp, isSimulated);
+
+                        // Verify all monomial commitments
+                        for(size_t i = 0; i < n; i++) {
+                            const auto& vk = params.getMonomialCommitment(i);
+                            //loginfo << "vk[" << i << "]: " << vk << endl;
+
+                            testAssertEqual(
+                                kpp.getG2toS() - params.omegas[i] * G2::one(), 
+                                vk);
+                        }
+
+                        // The streaming AMT must have the same quotient commitments and evaluations
+                        std::vector<Fr> evals;
+                        AuthRootsOfUnityEvaluation streamed(f, *params.accs, kpp, isSimulated, evals, arity);
+                        testAssertEqual(evals, eval.getEvaluations());
+                        testAssertEqual(streamed.tree.size(), authEval.tree.size());
+                        for(size_t k = 0; k < authEval.tree.size(); k++) {
+                            for(size_t idx = 0; idx < authEval.tree[k].size(); idx++) {
+                                testAssertEqual(streamed.tree[k][idx], authEval.tree[k][idx]);
+                            }
+                        }
                     }
                 }
 
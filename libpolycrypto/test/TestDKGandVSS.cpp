@@ -88,6 +88,48 @@ void testFeldman(const Dkg::DkgParams& params, const Dkg::FeldmanPublicParameter
     }
 
     testScheme(players, isDkgPlayer);
+
+    // the batched share checks must still catch a single bad share
+    if(isDkgPlayer) {
+        players[1]->shares[0] = players[1]->shares[0] + Fr::one();
+        testAssertFalse(players[0]->verifyOtherPlayers(players, false));
+    }
+
+    auto reconstructor = players[0];
+    size_t bad = static_cast<size_t>(rand()) % params.n;
+    reconstructor->shares[bad] = reconstructor->shares[bad] + Fr::one();
+    testAssertFalse(reconstructor->reconstructionVerify(random_subset(params.t, params.n), false));
+}
+
+/**
+ * Deals a Feldman DKG with dealAll(), which computes all players' shares with one batched FFT,
+ * and checks the shares against one FFT per player and the rest of the deal against the DKG checks.
+ */
+void testFeldmanDealAll(const Dkg::DkgParams& params, const Dkg::FeldmanPublicParameters& fpp) {
+    std::vector<Dkg::AbstractPlayer*> players;
+    for(size_t i = 0; i < params.n; i++) {
+        players.push_back(new Dkg::FeldmanPlayer(params, fpp, i, false, true));
+    }
+
+    Dkg::AbstractPlayer::dealAll(players);
+
+    for(auto p : players) {
+        std::vector<Fr> evals;
+        poly_fft(p->f_id, params.N, evals);
+        evals.resize(params.n);
+        testAssertEqual(p->shares, evals);
+    }
+
+    for(auto p : players) {
+        testAssertTrue(p->verifyOtherPlayers(players, false));
+    }
+    for(auto p : players) {
+        testAssertTrue(p->verifyFinalShareProof());
+    }
+
+    for(auto p : players) {
+        delete p;
+    }
 }
 
 template<class PlayerType>
@@ -145,17 +187,34 @@ int main(int argc, char *argv[]) {
     AccumulatorTree accs(maxN);
     AuthAccumulatorTree authAccs(accs, kpp, maxT);
 
+    // bad arities must throw, rather than divide by log2(arity) = 0
+    for(size_t arity : std::vector<size_t>{ 0, 1, 3 }) {
+        bool threw = false;
+        try {
+            Dkg::DkgParams params(minT, minT + 1, true, arity);
+        } catch(const std::runtime_error&) {
+            threw = true;
+        }
+        testAssertTrue(threw);
+    }
+
     for(size_t t = minT; t <= maxT; t++) {
         for(size_t n = t+1; n < maxT + 1; n++) {
             Dkg::DkgParams params(t, n, true);
             Dkg::FeldmanPublicParameters fpp(params);
             params.setAuthAccumulators(&authAccs);
 
+            // AMTs with shorter proofs
+            Dkg::DkgParams qaryParams(t, n, true, 4);
+            qaryParams.setAuthAccumulators(&authAccs);
+
             for(bool isDkg : { true, false }) {
                 loginfo << "Simulating " << t << " out of " << n << " " << (isDkg ? "DKG" : "VSS") << " ..." << endl;
 
                 loginfo << " * Feldman..." << endl;
                 testFeldman(params, fpp, isDkg);
+                if(isDkg)
+                    testFeldmanDealAll(params, fpp);
 
                 loginfo << " * Kate..." << endl;
                 testKateBasedScheme<Dkg::KatePlayer>(params, kpp, isDkg, true);
@@ -169,6 +228,10 @@ int main(int argc, char *argv[]) {
                 loginfo << " * AMTSim..." << endl;
                 testKateSimScheme<Dkg::MultipointPlayer>(params, kpp, isDkg);
 
+                loginfo << " * AMT with arity 4..." << endl;
+                testKateBasedScheme<Dkg::MultipointPlayer>(qaryParams, kpp, isDkg, false);
+                testKateSimScheme<Dkg::MultipointPlayer>(qaryParams, kpp, isDkg);
+
                 loginfo << endl;
             }
         }
@@ -0,0 +1,160 @@
+#include <polycrypto/Configuration.h>
+
+#include <polycrypto/PolyCrypto.h>
+#include <polycrypto/PolyOps.h>
+#include <polycrypto/FFT.h>
+
+#include <vector>
+
+#include <libfqfft/polynomial_arithmetic/basic_operations.hpp>
+#include <libfqfft/polynomial_arithmetic/naive_evaluate.hpp>
+
+#include <xassert/XAssert.h>
+#include <xutils/Log.h>
+
+using namespace std;
+using namespace libpolycrypto;
+
+void testFFT(size_t deg, size_t N) {
+    vector<Fr> p = random_field_elems(deg + 1), expected, vals;
+
+    // libfqfft's radix-2 FFT is the reference
+    expected = p;
+    expected.resize(N, Fr::zero());
+    libfqfft::_basic_serial_radix2_FFT(expected, libff::get_root_of_unity<Fr>(N));
+
+    fft(p, N, vals);
+    testAssertEqual(vals, expected);
+
+    vals = p;
+    vals.resize(N, Fr::zero());
+    fft_inplace(vals);
+    testAssertEqual(vals, expected);
+
+    poly_fft(p, N, vals);
+    testAssertEqual(vals, expected);
+
+    // check a few evaluations directly too
+    vector<Fr> omegas = get_all_roots_of_unity(N);
+    for(size_t i : std::vector<size_t>{ 0, 1, N/2, N - 1 }) {
+        if(i >= N)
+            continue;
+        testAssertEqual(vals[i], libfqfft::evaluate_polynomial(p.size(), p, omegas[i]));
+    }
+}
+
+void testTruncatedFFT(size_t L, size_t N, size_t numOut) {
+    vector<Fr> p = random_field_elems(L), expected, vals;
+
+    fft(p, N, expected);
+    expected.resize(numOut);
+
+    fft_truncated(p, N, numOut, vals);
+    testAssertEqual(vals, expected);
+}
+
+void testInverseFFT(size_t N) {
+    vector<Fr> p = random_field_elems(N), vals, q;
+
+    fft(p, N, vals);
+    ifft(vals, q);
+    testAssertEqual(q, p);
+
+    ifft_inplace(vals);
+    testAssertEqual(vals, p);
+
+    // over the coset g H, where g = 5 is not an Nth root of unity
+    Fr g = Fr(5);
+    coset_fft(p, N, g, vals);
+    for(size_t i : std::vector<size_t>{ 0, 1, N - 1 }) {
+        if(i >= N)
+            continue;
+        Fr x = g * (libff::get_root_of_unity<Fr>(N) ^ static_cast<unsigned long>(i));
+        testAssertEqual(vals[i], libfqfft::evaluate_polynomial(p.size(), p, x));
+    }
+
+    coset_ifft(vals, g, q);
+    testAssertEqual(q, p);
+}
+
+void testBatchFFT(size_t k, size_t N, size_t numOut) {
+    // polynomials of different lengths, including empty ones
+    vector<vector<Fr>> polys, vals;
+    for(size_t b = 0; b < k; b++) {
+        polys.push_back(random_field_elems(static_cast<size_t>(rand()) % (N + 1)));
+    }
+
+    fft_batch(polys, N, numOut, vals);
+    testAssertEqual(vals.size(), k);
+    for(size_t b = 0; b < k; b++) {
+        vector<Fr> expected;
+        fft_truncated(polys[b], N, numOut, expected);
+        testAssertEqual(vals[b], expected);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    (void)argc; (void)argv;
+
+    libpolycrypto::initialize(nullptr, 0);
+
+    // small sizes, sizes around FFTBlockSize, and big sizes with both radix-2 and radix-4 wide stages
+    for(size_t logN = 0; logN <= 15; logN++) {
+        size_t N = static_cast<size_t>(1) << logN;
+        loginfo << "Testing FFT of size " << N << endl;
+        testFFT(N - 1, N);
+        testFFT(N / 2, N);
+    }
+
+    // the input can also be the output
+    vector<Fr> p = random_field_elems(100), expected;
+    fft(p, 128, expected);
+    fft(p, 128, p);
+    testAssertEqual(p, expected);
+
+    // asking for a smaller N must not use stale twiddles from a bigger one, and vice versa
+    testFFT(7, 8);
+    testFFT(1 << 16, 1 << 17);
+    testFFT(7, 8);
+
+    for(size_t logN = 0; logN <= 14; logN += 2) {
+        size_t N = static_cast<size_t>(1) << logN;
+        loginfo << "Testing inverse and coset FFTs of size " << N << endl;
+        testInverseFFT(N);
+    }
+
+    // truncated FFTs, with every mix of input lengths and output counts
+    for(size_t logN = 0; logN <= 6; logN++) {
+        size_t N = static_cast<size_t>(1) << logN;
+        loginfo << "Testing truncated FFTs of size " << N << endl;
+        for(size_t L = 0; L <= N; L++) {
+            for(size_t numOut = 0; numOut <= N; numOut++) {
+                testTruncatedFFT(L, N, numOut);
+            }
+        }
+    }
+
+    // t-1 degree polynomials evaluated at n = 2t - 1 points, for sizes that go through the cache blocks
+    for(size_t t : std::vector<size_t>{ 1000, 2049, 5000, 8193, 20000 }) {
+        size_t n = 2*t - 1, N = Utils::smallestPowerOfTwoAbove(n);
+        loginfo << "Testing truncated FFT for t = " << t << ", n = " << n << endl;
+        testTruncatedFFT(t, N, n);
+        testTruncatedFFT(t, N, t);
+    }
+
+    // batched FFTs, with few and many lanes, and with rows wider than a cache block
+    for(size_t k : std::vector<size_t>{ 0, 1, 3, 16, 5000 }) {
+        for(size_t N : std::vector<size_t>{ 1, 2, 64, 4096 }) {
+            if(k * N > (1u << 20))
+                continue;
+            loginfo << "Testing " << k << " batched FFTs of size " << N << endl;
+            testBatchFFT(k, N, N);
+            testBatchFFT(k, N, N/2 + 1);
+        }
+    }
+
+    loginfo << "All tests succeeded!" << endl;
+
+    return 0;
+}
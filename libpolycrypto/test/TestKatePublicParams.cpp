@@ -1,9 +1,13 @@
 #include <polycrypto/Configuration.h>
 
+#include <algorithm>
 #include <cstdlib>
+#include <fstream>
+#include <utility>
 
 #include <polycrypto/PolyCrypto.h>
 #include <polycrypto/KatePublicParameters.h>
+#include <polycrypto/PointCompression.h>
 
 #include <xassert/XAssert.h>
 #include <xutils/Timer.h>
@@ -39,6 +43,122 @@ int main(int argc, char *argv[])
 
     KatePublicParameters pp(trapFile, 0, true, true);
 
+    // Generating the parameters in memory should give the same ones
+    KatePublicParameters mpp = KatePublicParameters::fromTrapdoor(s, q);
+    testAssertEqual(mpp.g1si, pp.g1si);
+    testAssertEqual(mpp.g2si, pp.g2si);
+
+    // The trapdoor-free check should accept the parameters...
+    testAssertTrue(pp.validatePowers());
+    {
+        // ...but not if any power in G1 or in G2 is off
+        KatePublicParameters bad = pp;
+        bad.g1si[q / 2] = bad.g1si[q / 2] + G1::one();
+        testAssertFalse(bad.validatePowers());
+
+        bad = pp;
+        bad.g1si[q] = bad.g1si[q - 1];
+        testAssertFalse(bad.validatePowers());
+
+        bad = pp;
+        bad.g2si[q / 3] = bad.g2si[q / 3] + G2::one();
+        testAssertFalse(bad.validatePowers());
+
+        bad = pp;
+        std::swap(bad.g1si[1], bad.g1si[2]);
+        std::swap(bad.g2si[1], bad.g2si[2]);
+        testAssertFalse(bad.validatePowers());
+
+        // ...or if a power in G2 is on the twist, but not in G2 (as a decompressed point could be)
+        if(libpolycrypto::PointCompressionSupported) {
+            bad = pp;
+            bool found = false;
+            unsigned char buf[G2CompressedSize];
+            for(unsigned char x = 1; x <= 64 && !found; x++) {
+                std::fill(buf, buf + G2CompressedSize, static_cast<unsigned char>(0));
+                buf[FieldElementBytes - 1] = x;
+                try {
+                    G2 p = decompressPoint<G2>(buf, false);
+                    found = !(G2::order() * p).is_zero();
+                    bad.g2si[q / 3] = p;
+                } catch(const std::runtime_error&) {
+                    // x^3 + b is not a square
+                }
+            }
+            testAssertTrue(found);
+            testAssertFalse(bad.validatePowers());
+        }
+    }
+
+    // Read only some of the parameters, stopping in the middle of a chunk
+    KatePublicParameters ppMax(trapFile, chunkSize + chunkSize / 2, false, true);
+    testAssertEqual(ppMax.g1si.size(), chunkSize + chunkSize / 2 + 1);
+    testAssertEqual(ppMax.g2si.back(), pp.g2si[chunkSize + chunkSize / 2]);
+
+    // Round-trip the parameters through the binary format
+    std::string binFile = trapFile + ".bin";
+    pp.writeBinary(binFile);
+
+    KatePublicParameters bpp = KatePublicParameters::fromBinary(binFile, trapFile);
+    testAssertEqual(bpp.q, pp.q);
+    testAssertEqual(bpp.s, pp.s);
+    testAssertEqual(bpp.g1si, pp.g1si);
+    testAssertEqual(bpp.g2si, pp.g2si);
+
+    // Same, but with compressed points, on the curves that support them
+    std::string cbinFile = trapFile + ".cbin";
+    std::vector<std::string> binFiles = { binFile };
+    if(libpolycrypto::PointCompressionSupported) {
+        pp.writeBinary(cbinFile, true);
+
+        KatePublicParameters cpp = KatePublicParameters::fromBinary(cbinFile, trapFile);
+        testAssertEqual(cpp.g1si, pp.g1si);
+        testAssertEqual(cpp.g2si, pp.g2si);
+        binFiles.push_back(cbinFile);
+    }
+
+    // Read only the G2 powers AMT needs, from all binary files
+    for(auto& file : binFiles) {
+        std::vector<size_t> g2Indices = KatePublicParameters::getAmtG2Indices(q);
+        KatePublicParameters spp = KatePublicParameters::fromBinaryWithG2Subset(file, g2Indices, trapFile);
+        testAssertEqual(spp.g1si, pp.g1si);
+        testAssertTrue(spp.g2si.empty());
+        testAssertEqual(spp.getG2toS(), pp.g2si[1]);
+        for(size_t i = 0; i <= q; i++) {
+            bool isIndex = std::find(g2Indices.begin(), g2Indices.end(), i) != g2Indices.end();
+            testAssertEqual(spp.hasG2si(i), isIndex);
+            if(isIndex)
+                testAssertEqual(spp.getG2si(i), pp.g2si[i]);
+        }
+    }
+
+    // Read only a prefix of the binary parameters
+    size_t maxQ = q / 2;
+    KatePublicParameters ppre = KatePublicParameters::fromBinary(binFile, "", maxQ);
+    testAssertEqual(ppre.q, maxQ);
+    testAssertEqual(ppre.g1si.size(), maxQ + 1);
+    testAssertEqual(ppre.g2si.back(), pp.g2si[maxQ]);
+
+    // Corrupt the last G2 record and make sure the checksum catches it
+    {
+        std::fstream f(binFile, std::ios::in | std::ios::out | std::ios::binary);
+        char c;
+        f.seekg(-1, std::ios::end);
+        f.read(&c, 1);
+        c = static_cast<char>(~c);
+        f.seekp(-1, std::ios::end);
+        f.write(&c, 1);
+    }
+
+    bool threw = false;
+    try {
+        KatePublicParameters::fromBinary(binFile, trapFile);
+    } catch(const std::runtime_error& e) {
+        logdbg << "Caught expected error: " << e.what() << endl;
+        threw = true;
+    }
+    testAssertTrue(threw);
+
     std::cout << "Test '" << argv[0] << "' finished successfully" << std::endl;
 
     return 0;
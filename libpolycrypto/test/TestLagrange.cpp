@@ -19,6 +19,42 @@ using namespace libfqfft;
 
 using libpolycrypto::Fr;
 
+void testInterpolate(size_t t, size_t n) {
+    size_t N = Utils::smallestPowerOfTwoAbove(n);
+    std::vector<Fr> omegas = get_all_roots_of_unity(N);
+
+    // n shares of a random degree t-1 polynomial
+    std::vector<Fr> f = random_field_elems(t), shares, interp;
+    poly_fft(f, N, shares);
+    shares.resize(n);
+
+    // any t of them give back f...
+    std::vector<size_t> T;
+    Utils::randomSubset<size_t>(T, static_cast<int>(n), static_cast<int>(t));
+    std::vector<Fr> evals;
+    for(auto i : T) {
+        evals.push_back(shares[i]);
+    }
+    interpolate_at_roots_of_unity(interp, omegas, T, evals);
+    testAssertEqual(interp, f);
+
+    // ...and all n of them give back f, padded with zeros, which is how we can tell they are consistent with degree t-1
+    std::vector<size_t> all;
+    for(size_t i = 0; i < n; i++) {
+        all.push_back(i);
+    }
+    interpolate_at_roots_of_unity(interp, omegas, all, shares);
+    testAssertEqual(interp.size(), n);
+    for(size_t i = 0; i < n; i++) {
+        testAssertEqual(interp[i], i < t ? f[i] : Fr::zero());
+    }
+
+    // a bad share is caught
+    shares[n - 1] += Fr::one();
+    interpolate_at_roots_of_unity(interp, omegas, all, shares);
+    testAssertNotEqual(interp[n - 1], Fr::zero());
+}
+
 int main() {
     libpolycrypto::initialize(nullptr, 0);
     srand(static_cast<unsigned int>(time(NULL)));
@@ -53,6 +89,15 @@ int main() {
         //logdbg << "L_naive = " << endl << L << endl;
     }
 
+    for (size_t t : std::vector<size_t>{ 1, 2, 3, 16, 33, 512, 1500 }) {
+        for (size_t n : std::vector<size_t>{ t + 1, 2*t - 1, 4*t }) {
+            if (n < t)
+                continue;
+            loginfo << "Interpolating degree " << t - 1 << " polynomial from " << n << " roots of unity" << endl;
+            testInterpolate(t, n);
+        }
+    }
+
     loginfo << "Test ended successfully!" << endl;
     return 0;
 }
@@ -0,0 +1,112 @@
+#include <polycrypto/PolyCrypto.h>
+
+#include <vector>
+
+#include <xutils/Log.h>
+#include <xassert/XAssert.h>
+
+using namespace std;
+using namespace libpolycrypto;
+
+/**
+ * Returns \prod_i e(ps[i], qs[i]), one pairing at a time.
+ */
+GT naiveMultiPairing(const vector<G1>& ps, const vector<G2>& qs) {
+    GT r = GT::one();
+    for(size_t i = 0; i < ps.size(); i++) {
+        r = r * ReducedPairing(ps[i], qs[i]);
+    }
+    return r;
+}
+
+void testMultiPairing(size_t n) {
+    vector<G1> ps = random_group_elems<G1>(n);
+    vector<G2> qs = random_group_elems<G2>(n);
+
+    testAssertEqual(MultiPairing(ps, qs), naiveMultiPairing(ps, qs));
+    testAssertEqual(FinalExponentiation(MultiMillerLoop(ps, qs)), MultiPairing(ps, qs));
+
+    // the product of the Miller loops is the Miller loop of the products
+    Fqk f = Fqk::one();
+    for(size_t i = 0; i < n; i++) {
+        f = f * MillerLoop(ps[i], qs[i]);
+    }
+    testAssertEqual(FinalExponentiation(f), MultiPairing(ps, qs));
+
+    // the point at infinity contributes nothing
+    if(n > 0) {
+        vector<G1> ps0 = ps;
+        vector<G2> qs0 = qs;
+        ps0[0] = G1::zero();
+        qs0[n - 1] = G2::zero();
+        testAssertEqual(MultiPairing(ps0, qs0), naiveMultiPairing(ps0, qs0));
+    }
+}
+
+void testPreparedG2(size_t n) {
+    vector<G1> ps = random_group_elems<G1>(n);
+    vector<G2> qs = random_group_elems<G2>(n);
+    if(n > 1)
+        qs[1] = G2::zero();
+
+    vector<PreparedG2> prepared;
+    for(auto& q : qs) {
+        prepared.push_back(PreparedG2(q));
+    }
+    vector<const PreparedG2*> qsPrep;
+    for(auto& q : prepared) {
+        qsPrep.push_back(&q);
+    }
+
+    for(size_t i = 0; i < n; i++) {
+        testAssertEqual(prepared[i].is_zero(), qs[i] == G2::zero());
+        testAssertEqual(MillerLoop(ps[i], prepared[i]), MillerLoop(ps[i], qs[i]));
+    }
+    testAssertEqual(MultiMillerLoop(ps, qsPrep), MultiMillerLoop(ps, qs));
+    testAssertEqual(MultiPairing(ps, qsPrep), naiveMultiPairing(ps, qs));
+
+    // prepared line coefficients can be reused across pairings
+    if(n > 0) {
+        testAssertEqual(MultiPairing(ps, qsPrep), MultiPairing(ps, qsPrep));
+        testAssertEqual(MillerLoop(ps[0], preparedG2One()), MillerLoop(ps[0], G2::one()));
+
+        // a default-constructed PreparedG2 is the point at infinity, and has no line coefficients to use
+        PreparedG2 zero;
+        testAssertTrue(zero.is_zero());
+        testAssertEqual(MillerLoop(ps[0], zero), Fqk::one());
+        testAssertEqual(MultiPairing({ ps[0] }, std::vector<const PreparedG2*>{ &zero }), GT::one());
+    }
+}
+
+void testPairingEquation() {
+    // e(a g, b h) = e(ab g, h), so e(-ab g, h) e(a g, b h) = 1
+    Fr a = Fr::random_element(), b = Fr::random_element();
+    testAssertEqual(MultiPairing({ -(a * b) * G1::one(), a * G1::one() }, { G2::one(), b * G2::one() }), GT::one());
+    testAssertNotEqual(MultiPairing({ -(a * b) * G1::one(), a * G1::one() }, { G2::one(), (b + Fr::one()) * G2::one() }), GT::one());
+}
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+    libpolycrypto::initialize(nullptr, 0);
+
+    for(size_t n = 0; n <= 9; n++) {
+        loginfo << "Testing a multi-pairing of " << n << " pairs..." << endl;
+        testMultiPairing(n);
+        testPreparedG2(n);
+    }
+
+    testPairingEquation();
+
+    bool threw = false;
+    try {
+        MultiPairing(random_group_elems<G1>(2), random_group_elems<G2>(3));
+    } catch(const std::runtime_error&) {
+        threw = true;
+    }
+    testAssertTrue(threw);
+
+    loginfo << "All tests succeeded!" << endl;
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include <polycrypto/Configuration.h>
+
+#include <polycrypto/PolyCrypto.h>
+#include <polycrypto/Pippenger.h>
+#include <polycrypto/FixedBaseMultiExp.h>
+#include <polycrypto/KatePublicParameters.h>
+#include <polycrypto/MultiExpProfile.h>
+
+#include <vector>
+
+#include <xassert/XAssert.h>
+#include <xutils/Log.h>
+
+using namespace std;
+using namespace libpolycrypto;
+
+template<class Group>
+Group naiveMultiExp(const vector<Group>& bases, const vector<Fr>& exps) {
+    Group r = Group::zero();
+    for(size_t i = 0; i < bases.size(); i++) {
+        r = r + exps[i] * bases[i];
+    }
+    return r;
+}
+
+template<class Group>
+void testPippenger(size_t n) {
+    vector<Group> bases = random_group_elems<Group>(n);
+    vector<Fr> exps = random_field_elems(n);
+
+    // throw in some edge cases
+    if(n > 4) {
+        exps[0] = Fr::zero();
+        exps[1] = Fr::one();
+        exps[2] = -Fr::one();
+        bases[3] = Group::zero();
+    }
+
+    // make half the bases affine and the other half projective, to exercise both kinds of additions
+    libff::batch_to_special(bases);
+    for(size_t i = 0; i < n; i += 2) {
+        bases[i] = (bases[i] + bases[i]) - bases[i];
+    }
+
+    Group expected = naiveMultiExp(bases, exps);
+    for(size_t numThreads : std::vector<size_t>{ 1, 2, 3, 8, 64 }) {
+        Group actual = pippengerMultiExp<Group, Fr>(bases.cbegin(), bases.cend(), exps.cbegin(), exps.cend(), numThreads);
+        testAssertEqual(actual, expected);
+    }
+
+    testAssertEqual(multiExp<Group>(bases, exps), expected);
+}
+
+template<class Group>
+void testFixedBase(size_t n, size_t window) {
+    vector<Group> bases = random_group_elems<Group>(n);
+    FixedBaseTable<Group> table(bases.cbegin(), bases.cend(), window);
+    testAssertEqual(table.getNumBases(), n);
+
+    // use all bases, or only a prefix of them
+    for(size_t m : std::vector<size_t>{ 0, 1, 3, n / 2, n }) {
+        vector<Fr> exps = random_field_elems(m);
+        if(m > 0)
+            exps[0] = -Fr::one();
+
+        vector<Group> prefix(bases.begin(), bases.begin() + static_cast<long>(m));
+        Group expected = naiveMultiExp(prefix, exps);
+        for(size_t numThreads : std::vector<size_t>{ 1, 4, 64 }) {
+            testAssertEqual(table.multiExp(exps.cbegin(), exps.cend(), numThreads), expected);
+        }
+        testAssertEqual(multiExp(table, exps), expected);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    (void)argc; (void)argv;
+
+    libpolycrypto::initialize(nullptr, 0);
+
+    for(size_t n : std::vector<size_t>{ 0, 1, 2, 5, 31, 32, 100, 1024, 3000 }) {
+        loginfo << "Testing Pippenger with n = " << n << endl;
+        testPippenger<G1>(n);
+        testPippenger<G2>(n);
+    }
+
+    // all exponents with every bit set in the last window
+    vector<G1> bases = random_group_elems<G1>(64);
+    vector<Fr> exps(64, -Fr::one());
+    testAssertEqual(
+        (pippengerMultiExp<G1, Fr>(bases.cbegin(), bases.cend(), exps.cbegin(), exps.cend(), 4)),
+        naiveMultiExp(bases, exps));
+
+    for(size_t window : std::vector<size_t>{ 0, 1, 5, 8, 13 }) {
+        loginfo << "Testing fixed-base tables with window " << window << endl;
+        testFixedBase<G1>(200, window);
+        testFixedBase<G2>(50, window);
+    }
+
+    // the memory budget should constrain the window
+    size_t budget = FixedBaseTable<G1>::getMemoryUsage(bases.size(), 16);
+    FixedBaseTable<G1> small(bases.cbegin(), bases.cend(), 0, budget);
+    testAssertLessThanOrEqual(small.getMemoryUsage(), budget);
+    testAssertGreaterThanOrEqual(small.getWindowSize(), 16);
+
+    // batches of multiexps of various sizes over prefixes of the same bases
+    {
+        vector<G1> bbases = random_group_elems<G1>(2000);
+        vector<vector<Fr>> exps;
+        for(size_t m : std::vector<size_t>{ 1, 2, 0, 2000, 17, 3, 1500, 5, 5, 64 }) {
+            exps.push_back(random_field_elems(m));
+        }
+
+        vector<const vector<Fr>*> ptrs;
+        for(auto& e : exps)
+            ptrs.push_back(&e);
+
+        FixedBaseTable<G1> btable(bbases.cbegin(), bbases.cend());
+        vector<G1> results = multiExpBatch<G1>(bbases, ptrs);
+        vector<G1> tresults = multiExpBatch(btable, ptrs);
+        testAssertEqual(results.size(), exps.size());
+        for(size_t j = 0; j < exps.size(); j++) {
+            vector<G1> prefix(bbases.begin(), bbases.begin() + static_cast<long>(exps[j].size()));
+            testAssertEqual(results[j], naiveMultiExp(prefix, exps[j]));
+            testAssertEqual(tresults[j], results[j]);
+        }
+
+        // the grain size only changes how the multiexps are grouped into tasks
+        for(size_t grainSize : std::vector<size_t>{ 0, 1, 1000000 }) {
+            testAssertEqual(multiExpBatch<G1>(bbases, ptrs, grainSize), results);
+            testAssertEqual(multiExpBatch(btable, ptrs, grainSize), results);
+        }
+    }
+
+    // multiexp profiles should round-trip and be picked up by multiExp()
+    {
+        MultiExpThresholds defaults = getMultiExpThresholds<G1>();
+
+        MultiExpProfileEntry e1, e2;
+        e1.group = "G1";
+        e1.numThreads = getNumCores();
+        e1.thresholds.bosCoster = 3;
+        e1.thresholds.bdlo12 = 100;
+        e1.thresholds.pippenger = 200;
+        e2.group = "G2";
+        e2.numThreads = getNumCores();
+        e2.thresholds = getMultiExpThresholds<G2>();
+
+        std::string profileFile = "/tmp/libpolycrypto-test-multiexp-profile";
+        writeMultiExpProfile(profileFile, { e1, e2 });
+        testAssertTrue(loadMultiExpProfile(profileFile));
+        testAssertEqual(getMultiExpThresholds<G1>().bdlo12, 100);
+        testAssertEqual(getMultiExpThresholds<G1>().pippenger, 200);
+
+        // all methods should still compute the same thing
+        for(size_t n : std::vector<size_t>{ 2, 50, 150, 300 }) {
+            vector<G1> b = random_group_elems<G1>(n);
+            vector<Fr> e = random_field_elems(n);
+            testAssertEqual(multiExp<G1>(b, e), naiveMultiExp(b, e));
+        }
+
+        // a profile for another number of threads should be ignored
+        e1.numThreads = e2.numThreads = getNumCores() + 1;
+        writeMultiExpProfile(profileFile, { e1, e2 });
+        getMultiExpThresholds<G1>() = defaults;
+        testAssertFalse(loadMultiExpProfile(profileFile));
+        testAssertEqual(getMultiExpThresholds<G1>().bdlo12, defaults.bdlo12);
+
+        // the calibration should produce thresholds in order
+        MultiExpThresholds th = calibrateMultiExp<G1>(1, 64, 1);
+        testAssertLessThanOrEqual(th.bosCoster, th.bdlo12);
+        testAssertLessThanOrEqual(th.bdlo12, th.pippenger);
+    }
+
+    // commitments with and without the table should match
+    Dkg::KatePublicParameters kpp = Dkg::KatePublicParameters::getRandom(300);
+    vector<Fr> poly = random_field_elems(301), shortPoly = random_field_elems(7);
+    G1 comm = kpp.commit(poly), shortComm = kpp.commit(shortPoly);
+    testAssertEqual(comm, naiveMultiExp(kpp.g1si, poly));
+    kpp.precomputeG1Table(100);
+    testAssertTrue(kpp.hasG1Table());
+    testAssertEqual(kpp.commit(poly), comm);
+    testAssertEqual(kpp.commit(shortPoly), shortComm);
+
+    std::cout << "Test '" << argv[0] << "' finished successfully" << std::endl;
+
+    return 0;
+}
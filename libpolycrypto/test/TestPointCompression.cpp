@@ -0,0 +1,163 @@
+#include <polycrypto/Configuration.h>
+
+#include <polycrypto/PolyCrypto.h>
+#include <polycrypto/PointCompression.h>
+#include <polycrypto/AmtDkg.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include <xassert/XAssert.h>
+#include <xutils/Log.h>
+
+using namespace std;
+using namespace libpolycrypto;
+
+template<class Func>
+bool throwsRuntimeError(Func f) {
+    try {
+        f();
+    } catch(const std::runtime_error& e) {
+        logdbg << "Caught expected error: " << e.what() << endl;
+        return true;
+    }
+    return false;
+}
+
+template<class Group>
+void testRoundTrip(size_t count) {
+    vector<Group> points;
+    points.push_back(Group::zero());
+    points.push_back(Group::one());
+    points.push_back(-Group::one());
+    for(size_t i = 0; i < count; i++) {
+        points.push_back(Group::random_element());
+    }
+
+    // compress one at a time
+    for(auto& p : points) {
+        unsigned char buf[CompressedPoint<Group>::Size];
+        compressPoint<Group>(p, buf);
+        testAssertEqual(decompressPoint<Group>(buf), p);
+    }
+
+    // compress in batch
+    vector<unsigned char> buf = compressPoints(points);
+    testAssertEqual(buf.size(), points.size() * CompressedPoint<Group>::Size);
+    testAssertEqual(decompressPoints<Group>(buf), points);
+
+    // infinity must be canonical
+    unsigned char zero[CompressedPoint<Group>::Size];
+    compressPoint<Group>(Group::zero(), zero);
+    zero[CompressedPoint<Group>::Size - 1] = 1;
+    testAssertTrue(throwsRuntimeError([&zero]() { decompressPoint<Group>(zero); }));
+
+    // x coordinates must be reduced
+    vector<unsigned char> big(CompressedPoint<Group>::Size, 0xff);
+    big[0] = 0x3f;
+    testAssertTrue(throwsRuntimeError([&big]() { decompressPoint<Group>(big.data()); }));
+
+    // truncated buffers are rejected
+    buf.pop_back();
+    testAssertTrue(throwsRuntimeError([&buf]() { decompressPoints<Group>(buf); }));
+}
+
+/**
+ * Encodes the small integer x as the x coordinate(s) of a compressed point (for G2, x + x u).
+ */
+template<class Group>
+vector<unsigned char> encodeSmallX(unsigned char x) {
+    vector<unsigned char> buf(CompressedPoint<Group>::Size, 0);
+    for(size_t c = 0; c < CompressedPoint<Group>::NumCoords; c++) {
+        buf[(c + 1) * FieldElementBytes - 1] = x;
+    }
+    return buf;
+}
+
+/**
+ * About half of all x's have no point on the curve (x^3 + b is not a square), and decoding
+ * such an x must throw, rather than try to take the square root of a non-square.
+ */
+template<class Group>
+void testNotOnCurve() {
+    size_t numRejected = 0, numDecoded = 0;
+    for(unsigned char x = 1; x <= 64; x++) {
+        vector<unsigned char> buf = encodeSmallX<Group>(x);
+        // skip the subgroup check, so that only the points that are not on the curve are rejected
+        if(throwsRuntimeError([&buf]() { decompressPoint<Group>(buf.data(), false); })) {
+            numRejected++;
+            continue;
+        }
+
+        numDecoded++;
+        Group p = decompressPoint<Group>(buf.data(), false);
+        testAssertTrue(p.is_well_formed());
+
+        // the point decodes to itself, with either sign
+        vector<unsigned char> enc(CompressedPoint<Group>::Size);
+        compressPoint<Group>(p, enc.data());
+        enc[0] = static_cast<unsigned char>(enc[0] & ~PointSignFlag);
+        testAssertEqual(enc, buf);
+    }
+
+    loginfo << numRejected << " out of " << numRejected + numDecoded << " x's are not on the curve" << endl;
+    testAssertStrictlyGreaterThan(numRejected, 0);
+    testAssertStrictlyGreaterThan(numDecoded, 0);
+}
+
+/**
+ * G2's curve has points outside of G2 (unlike G1's), so decoding them must throw, unless the
+ * subgroup check is skipped.
+ */
+void testNotInSubgroup() {
+    size_t numOutside = 0;
+    for(unsigned char x = 1; x <= 64; x++) {
+        vector<unsigned char> buf = encodeSmallX<G2>(x);
+        if(throwsRuntimeError([&buf]() { decompressPoint<G2>(buf.data(), false); }))
+            continue;
+
+        G2 p = decompressPoint<G2>(buf.data(), false);
+        if(!(G2::order() * p).is_zero()) {
+            numOutside++;
+            testAssertTrue(throwsRuntimeError([&buf]() { decompressPoint<G2>(buf.data()); }));
+        }
+    }
+
+    testAssertStrictlyGreaterThan(numOutside, 0);
+
+    // points from G2 pass the check
+    G2 p = G2::random_element();
+    unsigned char buf[G2CompressedSize];
+    compressPoint<G2>(p, buf);
+    testAssertEqual(decompressPoint<G2>(buf, true), p);
+}
+
+int main(int argc, char *argv[])
+{
+    (void)argc; (void)argv;
+
+    libpolycrypto::initialize(nullptr, 0);
+
+    if(!PointCompressionSupported) {
+        logwarn << "Point compression is not implemented for this curve, skipping test" << endl;
+        return 0;
+    }
+
+    testRoundTrip<G1>(128);
+    testRoundTrip<G2>(128);
+
+    testNotOnCurve<G1>();
+    testNotOnCurve<G2>();
+    testNotInSubgroup();
+
+    // AMT proofs are sent as compressed quotient commitments
+    Dkg::AmtProof pi;
+    pi.quoComms = random_group_elems<G1>(16);
+    vector<unsigned char> bytes = pi.toBytes();
+    testAssertEqual(bytes.size(), 16 * G1CompressedSize);
+    testAssertEqual(Dkg::AmtProof::fromBytes(bytes).quoComms, pi.quoComms);
+
+    std::cout << "Test '" << argv[0] << "' finished successfully" << std::endl;
+
+    return 0;
+}
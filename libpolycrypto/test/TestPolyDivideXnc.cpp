@@ -53,6 +53,34 @@ int main(int argc, char *argv[])
         //poly_print(a); std::cout << endl;
         //poly_print(rhs); std::cout << endl;
         testAssertEqual(a, rhs);
+
+        // must agree with the naive division
+        vector<Fr> qs, rs;
+        poly_divide_xnc_slow(a, b, qs, rs);
+        testAssertEqual(q, qs);
+        testAssertEqual(r, rs);
+    }
+
+    // small cases: a shorter than b, a as long as b, and the remainder computed in place over a
+    for(size_t m = 1; m <= 8; m++) {
+        for(size_t len = 1; len <= 3*m + 2; len++) {
+            vector<Fr> a = random_field_elems(len), q, r, qs, rs;
+            XncPoly b(m, Fr::random_element());
+
+            poly_divide_xnc(a, b, q, r);
+            poly_divide_xnc_slow(a, b, qs, rs);
+            testAssertEqual(q, qs);
+            testAssertEqual(r, rs);
+
+            if(len > m) {
+                vector<Fr> inPlace = a;
+                q.assign(len - m, Fr::zero());
+                poly_divide_xnc(inPlace.data(), inPlace.size(), b, q.data(), inPlace.data());
+                inPlace.resize(m);
+                testAssertEqual(q, qs);
+                testAssertEqual(inPlace, rs);
+            }
+        }
     }
 
     return 0;
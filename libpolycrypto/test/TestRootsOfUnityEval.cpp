@@ -21,12 +21,13 @@ using namespace libpolycrypto;
 
 void assertEvals(const std::vector<Fr>& f, const std::vector<Fr>& evals, size_t numPoints);
 
-void testRootsOfUnityEvaluation(size_t deg, const AccumulatorTree& accs) {
+void testRootsOfUnityEvaluation(size_t deg, const AccumulatorTree& accs, size_t arity) {
     size_t numPoints = accs.getNumPoints();
 
     std::vector<Fr> f = random_field_elems(deg+1);
 
-    RootsOfUnityEvaluation eval(f, accs);
+    RootsOfUnityEvaluation eval(f, accs, arity);
+    testAssertEqual(eval.getArity(), arity);
 
     testAssertTrue(eval._testIsConsistent());
 
@@ -34,18 +35,21 @@ void testRootsOfUnityEvaluation(size_t deg, const AccumulatorTree& accs) {
     assertEvals(f, evals, numPoints);
 }
 
-void testMultipointMerging(size_t deg, const AccumulatorTree& accs) {
+/**
+ * Merges the evaluations of a degree deg1 and of a degree deg2 polynomial, which must have the same root level.
+ */
+void testMultipointMerging(size_t deg1, size_t deg2, const AccumulatorTree& accs, size_t arity) {
     size_t numPoints = accs.getNumPoints();
 
     std::vector<Fr> f1, f2, f3;
-    f1 = random_field_elems(deg+1);
-    f2 = random_field_elems(deg+1);
+    f1 = random_field_elems(deg1+1);
+    f2 = random_field_elems(deg2+1);
 
     libfqfft::_polynomial_addition(f3, f1, f2);
 
     // evaluate f1 and f2
-    RootsOfUnityEvaluation eval1(f1, accs);
-    RootsOfUnityEvaluation eval2(f2, accs);
+    RootsOfUnityEvaluation eval1(f1, accs, arity);
+    RootsOfUnityEvaluation eval2(f2, accs, arity);
 
     testAssertTrue(eval1._testIsConsistent());
     testAssertTrue(eval2._testIsConsistent());
@@ -59,6 +63,20 @@ void testMultipointMerging(size_t deg, const AccumulatorTree& accs) {
     assertEvals(f3, eval1.getEvaluations(), numPoints);
 }
 
+/**
+ * Big enough for the tree to be computed in parallel (see RootsOfUnityEvalSerialLevel), so we check against an FFT.
+ */
+void testBigRootsOfUnityEvaluation(size_t deg, size_t numPoints) {
+    AccumulatorTree accs(numPoints);
+    std::vector<Fr> f = random_field_elems(deg+1), expected;
+
+    fft_truncated(f, accs.getNumLeaves(), numPoints, expected);
+    for(size_t arity : std::vector<size_t>{ 2, 16 }) {
+        RootsOfUnityEvaluation eval(f, accs, arity);
+        testAssertEqual(eval.getEvaluations(), expected);
+    }
+}
+
 int main() {
     libpolycrypto::initialize(nullptr, 0);
 
@@ -66,9 +84,32 @@ int main() {
         for (size_t deg = 1; deg <= 32; deg++) {
             loginfo << "Evaluating degree " << deg << " polynomials at the first " << numPoints << " roots of unity" << endl;
             AccumulatorTree accs(numPoints);
-            testRootsOfUnityEvaluation(deg, accs);
-            testMultipointMerging(deg, accs);
+            for(size_t arity : std::vector<size_t>{ 2, 4, 8 }) {
+                testRootsOfUnityEvaluation(deg, accs, arity);
+                testMultipointMerging(deg, deg, accs, arity);
+                // the lowest degree with the same root level as deg (i.e., 2^{\lfloor \log{deg} \rfloor}), merged both ways
+                size_t lowDeg = 1u << Utils::log2floor(deg);
+                testMultipointMerging(lowDeg, deg, accs, arity);
+                testMultipointMerging(deg, lowDeg, accs, arity);
+            }
+        }
+    }
+
+    // bad arities must throw, rather than divide by log2(arity) = 0
+    AccumulatorTree accs(8);
+    for(size_t arity : std::vector<size_t>{ 0, 1, 3 }) {
+        bool threw = false;
+        try {
+            RootsOfUnityEvaluation eval(random_field_elems(4), accs, arity);
+        } catch(const std::runtime_error&) {
+            threw = true;
         }
+        testAssertTrue(threw);
+    }
+
+    for (auto p : std::vector<std::pair<size_t, size_t>>{ {2500, 5000}, {4000, 3000}, {1 << 13, (1 << 14) + 1} }) {
+        loginfo << "Evaluating degree " << p.first << " polynomial at the first " << p.second << " roots of unity" << endl;
+        testBigRootsOfUnityEvaluation(p.first, p.second);
     }
 
     loginfo << "Test passed!" << endl;
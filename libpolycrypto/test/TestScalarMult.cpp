@@ -0,0 +1,154 @@
+#include <polycrypto/Configuration.h>
+
+#include <polycrypto/PolyCrypto.h>
+#include <polycrypto/ScalarMult.h>
+
+#include <vector>
+
+#include <xassert/XAssert.h>
+#include <xutils/Log.h>
+
+using namespace std;
+using namespace libpolycrypto;
+
+/**
+ * Returns a primitive cube root of unity in Fr, which is the GLV eigenvalue on curves with j = 0.
+ */
+Fr cubeRootOfUnity() {
+    typedef decltype(Fr::field_char()) BigInt;
+
+    mpz_t e;
+    mpz_init(e);
+    Fr::field_char().to_mpz(e);
+    mpz_sub_ui(e, e, 1);
+    mpz_divexact_ui(e, e, 3);
+    BigInt exp(e);
+    mpz_clear(e);
+
+    while(true) {
+        Fr c = Fr::random_element() ^ exp;
+        if(c != Fr::one())
+            return c;
+    }
+}
+
+/**
+ * Returns m mod r, for a possibly negative m.
+ */
+Fr toField(const mpz_t m) {
+    typedef decltype(Fr::field_char()) BigInt;
+
+    mpz_t a;
+    mpz_init(a);
+    mpz_abs(a, m);
+    Fr f = Fr(BigInt(a));
+    mpz_clear(a);
+
+    return mpz_sgn(m) < 0 ? -f : f;
+}
+
+vector<Fr> edgeCaseScalars(const Fr& lambda) {
+    vector<Fr> ks = random_field_elems(32);
+    ks.push_back(Fr::zero());
+    ks.push_back(Fr::one());
+    ks.push_back(-Fr::one());
+    ks.push_back(lambda);
+    ks.push_back(-lambda);
+    ks.push_back(lambda + Fr::one());
+    return ks;
+}
+
+template<class Group>
+void testGlv(const Fr& lambda, bool checkShort) {
+    GlvBasis basis(lambda);
+    auto phi = [&lambda](const Group& q) { return lambda * q; };
+
+    mpz_t k1, k2;
+    mpz_init(k1);
+    mpz_init(k2);
+
+    Group p = Group::random_element();
+    for(auto& k : edgeCaseScalars(lambda)) {
+        // k = k1 + k2 \lambda
+        basis.decompose(k, k1, k2);
+
+        Fr f1 = toField(k1), f2 = toField(k2);
+        testAssertEqual(f1 + f2 * lambda, k);
+
+        if(checkShort) {
+            testAssertLessThanOrEqual(mpz_sizeinbase(k1, 2), Fr::size_in_bits() / 2 + 2);
+            testAssertLessThanOrEqual(mpz_sizeinbase(k2, 2), Fr::size_in_bits() / 2 + 2);
+        }
+
+        testAssertEqual(glvMul(k, p, phi, basis), k * p);
+        testAssertEqual(glvMul(k, Group::zero(), phi, basis), Group::zero());
+    }
+
+    mpz_clear(k1);
+    mpz_clear(k2);
+}
+
+template<class Group>
+void testScalarMul() {
+    for(size_t i = 0; i < 16; i++) {
+        Group p = Group::random_element();
+        for(auto& k : edgeCaseScalars(Fr::random_element())) {
+            testAssertEqual(scalarMul(k, p), k * p);
+        }
+    }
+
+    testAssertEqual(scalarMul(Fr::random_element(), Group::zero()), Group::zero());
+}
+
+void testGeneratorExp() {
+    vector<Fr> ks = edgeCaseScalars(Fr::random_element());
+
+    for(auto& k : ks) {
+        testAssertEqual(g1Exp(k), k * G1::one());
+        testAssertEqual(g2Exp(k), k * G2::one());
+    }
+
+    vector<G1> g1s = g1ExpBatch(ks);
+    vector<G2> g2s = g2ExpBatch(ks);
+    testAssertEqual(g1s.size(), ks.size());
+    testAssertEqual(g2s.size(), ks.size());
+    for(size_t i = 0; i < ks.size(); i++) {
+        testAssertEqual(g1s[i], ks[i] * G1::one());
+        testAssertEqual(g2s[i], ks[i] * G2::one());
+    }
+
+    testAssertTrue(g1ExpBatch(vector<Fr>()).empty());
+}
+
+int main(int argc, char *argv[])
+{
+    (void)argc; (void)argv;
+
+    libpolycrypto::initialize(nullptr, 0);
+
+    loginfo << "Testing GLV with a cube root of unity as the eigenvalue..." << endl;
+    Fr omega = cubeRootOfUnity();
+    testGlv<G1>(omega, true);
+    testGlv<G2>(omega, true);
+
+    // the decomposition must be correct for any eigenvalue, even if it is not short
+    loginfo << "Testing GLV with random eigenvalues..." << endl;
+    for(size_t i = 0; i < 8; i++) {
+        testGlv<G1>(Fr::random_element(), false);
+    }
+    testGlv<G1>(Fr::one(), false);
+    testGlv<G1>(-Fr::one(), false);
+
+    loginfo << "Testing scalarMul() against k * P..." << endl;
+    loginfo << " * G1 uses " << (Endomorphism<G1>::Enabled ? "GLV" : "wNAF") << endl;
+    loginfo << " * G2 uses " << (Endomorphism<G2>::Enabled ? "GLS" : "wNAF") << endl;
+    testScalarMul<G1>();
+    testScalarMul<G2>();
+
+    loginfo << "Testing g1Exp() and g2Exp()..." << endl;
+    testGeneratorExp();
+
+    loginfo << "All tests succeeded!" << endl;
+
+    return 0;
+}